@@ -197,6 +197,61 @@ class BParseOptionsTestCase(unittest.TestCase):
         po = ParseOptions(spell_guess=False)
         self.assertEqual(po.spell_guess, 0)
 
+    def test_setting_lazy_linkages(self):
+        po = ParseOptions()
+        po.lazy_linkages = True
+        self.assertEqual(po.lazy_linkages, True)
+        self.assertEqual(clg.parse_options_get_lazy_linkages(po._obj), 1)
+        po.lazy_linkages = False
+        self.assertEqual(po.lazy_linkages, False)
+        self.assertEqual(clg.parse_options_get_lazy_linkages(po._obj), 0)
+
+    def test_setting_lazy_linkages_to_non_boolean_raises_type_error(self):
+        po = ParseOptions()
+        self.assertRaises(TypeError, setattr, po, "lazy_linkages", "a")
+
+    def test_setting_parse_forest(self):
+        po = ParseOptions()
+        po.parse_forest = True
+        self.assertEqual(po.parse_forest, True)
+        self.assertEqual(clg.parse_options_get_parse_forest(po._obj), 1)
+        po.parse_forest = False
+        self.assertEqual(po.parse_forest, False)
+        self.assertEqual(clg.parse_options_get_parse_forest(po._obj), 0)
+
+    def test_setting_parse_forest_to_non_boolean_raises_type_error(self):
+        po = ParseOptions()
+        self.assertRaises(TypeError, setattr, po, "parse_forest", "a")
+
+    def test_setting_kbest(self):
+        po = ParseOptions(kbest=True)
+        self.assertEqual(po.kbest, True)
+        self.assertEqual(clg.parse_options_get_kbest(po._obj), 1)
+        po.kbest = False
+        self.assertEqual(po.kbest, False)
+        self.assertEqual(clg.parse_options_get_kbest(po._obj), 0)
+
+    def test_setting_kbest_to_non_boolean_raises_type_error(self):
+        po = ParseOptions()
+        self.assertRaises(TypeError, setattr, po, "kbest", "a")
+
+    def test_setting_threads(self):
+        self.assertEqual(ParseOptions().threads, 1)
+        po = ParseOptions(threads=3)
+        self.assertEqual(po.threads, 3)
+        self.assertEqual(clg.parse_options_get_threads(po._obj), 3)
+        po.threads = 1
+        self.assertEqual(po.threads, 1)
+        self.assertEqual(clg.parse_options_get_threads(po._obj), 1)
+
+    def test_setting_threads_to_non_integer_raises_type_error(self):
+        po = ParseOptions()
+        self.assertRaises(TypeError, setattr, po, "threads", "a")
+
+    def test_setting_threads_to_zero_raises_value_error(self):
+        po = ParseOptions()
+        self.assertRaises(ValueError, setattr, po, "threads", 0)
+
     def test_specifying_parse_options(self):
         po = ParseOptions(linkage_limit=99)
         self.assertEqual(clg.parse_options_get_linkage_limit(po._obj), 99)
@@ -300,6 +355,62 @@ class DBasicParsingTestCase(unittest.TestCase):
         self.assertTrue(isinstance(result[0], Linkage))
         self.assertTrue(isinstance(result[1], Linkage))
 
+    def test_lazy_linkages(self):
+        text = "The fact that he smiled at me gives me hope."
+        eager = [l.diagram() for l in self.parse_sent(text)]
+        lazy = [l.diagram() for l in
+                self.parse_sent(text, ParseOptions(lazy_linkages=True))]
+        self.assertTrue(1 < len(eager))
+        self.assertEqual(sorted(lazy), sorted(eager))
+
+    def test_kbest_linkages(self):
+        text = "The fact that he smiled at me gives me hope."
+        all_costs = sorted(l.disjunct_cost() for l in self.parse_sent(text))
+        best = self.parse_sent(text, ParseOptions(kbest=True, linkage_limit=3))
+        costs = [l.disjunct_cost() for l in best]
+        self.assertEqual(len(costs), 3)
+        self.assertEqual(costs, sorted(costs))
+        self.assertEqual(costs, all_costs[:3])
+
+    def test_lazy_kbest_linkages(self):
+        text = "The fact that he smiled at me gives me hope."
+        eager = [l.diagram() for l in
+                 self.parse_sent(text, ParseOptions(kbest=True, linkage_limit=5))]
+        lazy = [l.diagram() for l in
+                self.parse_sent(text, ParseOptions(kbest=True, linkage_limit=5,
+                                                   lazy_linkages=True))]
+        self.assertEqual(len(eager), 5)
+        self.assertEqual(lazy, eager)
+
+    def test_threads_linkages(self):
+        text = "Frank felt vindicated when his long time friend Bill revealed " \
+               "that he was the winner of the competition."
+        one = [l.diagram() for l in self.parse_sent(text, ParseOptions(threads=1))]
+        for n in (2, 4):
+            many = [l.diagram() for l in
+                    self.parse_sent(text, ParseOptions(threads=n))]
+            self.assertEqual(many, one)
+
+    def test_parse_forest_count(self):
+        sent = Sentence("The fact that he smiled at me gives me hope.",
+                        self.d, ParseOptions(parse_forest=True))
+        sent.parse()
+        pf = clg.sentence_get_parse_forest(sent._obj)
+        # The sub-nodes precede their node, and the root is the last one.
+        count = []
+        for n in range(clg.parse_forest_get_num_nodes(pf)):
+            first = clg.parse_forest_get_node_first_choice(pf, n)
+            num = clg.parse_forest_get_node_num_choices(pf, n)
+            c = 0 if num else 1
+            for k in range(first, first + num):
+                c += count[clg.parse_forest_get_choice_left(pf, k)] * \
+                     count[clg.parse_forest_get_choice_right(pf, k)]
+            count.append(c)
+        self.assertTrue(1 < count[-1])
+        self.assertEqual(count[-1], clg.sentence_num_linkages_found(sent._obj))
+        self.assertEqual(clg.parse_forest_get_node_first_choice(pf, len(count)),
+                         clg.PARSE_FOREST_BAD_INDEX)
+
     def test_getting_link_distances(self):
         linkage = self.parse_sent("This is a sentence.")[0]
         self.assertEqual([len(l) for l in linkage.links()], [5,2,1,1,2,1,1])
@@ -40,7 +40,11 @@ class ParseOptions(object):
                  spell_guess=False,
                  use_sat=False,
                  max_parse_time=-1,
-                 disjunct_cost=2.7):
+                 disjunct_cost=2.7,
+                 lazy_linkages=False,
+                 parse_forest=False,
+                 kbest=False,
+                 threads=1):
 
         self._obj = clg.parse_options_create()
         self.verbosity = verbosity
@@ -55,6 +59,10 @@ class ParseOptions(object):
         self.use_sat = use_sat
         self.max_parse_time = max_parse_time
         self.disjunct_cost = disjunct_cost
+        self.lazy_linkages = lazy_linkages
+        self.parse_forest = parse_forest
+        self.kbest = kbest
+        self.threads = threads
 
     # Allow only the attribute names listed below.
     def __setattr__(self, name, value):
@@ -197,7 +205,8 @@ class ParseOptions(object):
          allowed to take. After this time has expired, the parsing process is
          artificially forced to complete quickly by pretending that no further
          solutions can be constructed. The actual parsing time might be
-         slightly longer.
+         slightly longer. This is the elapsed (wall-clock) time, not the
+         CPU time.
         """
         return clg.parse_options_get_max_parse_time(self._obj)
 
@@ -274,6 +283,66 @@ class ParseOptions(object):
             raise TypeError("all_short_connectors must be set to a bool")
         clg.parse_options_set_all_short_connectors(self._obj, 1 if value else 0)
 
+    @property
+    def lazy_linkages(self):
+        """
+         If true, the linkages are extracted and post-processed only when
+         they are iterated over, so getting only the first ones is faster.
+        """
+        return clg.parse_options_get_lazy_linkages(self._obj) == 1
+
+    @lazy_linkages.setter
+    def lazy_linkages(self, value):
+        if not isinstance(value, bool):
+            raise TypeError("lazy_linkages must be set to a bool")
+        clg.parse_options_set_lazy_linkages(self._obj, value)
+
+    @property
+    def parse_forest(self):
+        """
+         If true, the packed parse forest of the sentence is kept, and
+         can be walked with the clinkgrammar parse_forest_* functions.
+        """
+        return clg.parse_options_get_parse_forest(self._obj) == 1
+
+    @parse_forest.setter
+    def parse_forest(self, value):
+        if not isinstance(value, bool):
+            raise TypeError("parse_forest must be set to a bool")
+        clg.parse_options_set_parse_forest(self._obj, value)
+
+    @property
+    def kbest(self):
+        """
+         If true, and the sentence has more linkages than linkage_limit,
+         the linkage_limit lowest-cost ones are used, instead of a random
+         sample of them. Lazy linkages are then in the same order as the
+         other ones.
+        """
+        return clg.parse_options_get_kbest(self._obj) == 1
+
+    @kbest.setter
+    def kbest(self, value):
+        if not isinstance(value, bool):
+            raise TypeError("kbest must be set to a bool")
+        clg.parse_options_set_kbest(self._obj, value)
+
+    @property
+    def threads(self):
+        """
+         The number of threads used for parsing long sentences. The default
+         is 1. The results don't depend on it.
+        """
+        return clg.parse_options_get_threads(self._obj)
+
+    @threads.setter
+    def threads(self, value):
+        if not isinstance(value, int):
+            raise TypeError("threads must be set to an integer")
+        if value < 1:
+            raise ValueError("threads must be at least 1")
+        clg.parse_options_set_threads(self._obj, value)
+
 
 class LG_Error(Exception):
     @staticmethod
@@ -373,7 +442,10 @@ class Linkage(object):
     def __init__(self, idx, sentence, parse_options):
         # Keep all args passed into clg.* functions.
         self.sentence, self.parse_options = sentence, parse_options
-        self._obj = clg.linkage_create(idx, sentence._obj, parse_options)
+        if idx is None: # The next valid linkage
+            self._obj = clg.sentence_next_linkage(sentence._obj, parse_options)
+        else:
+            self._obj = clg.linkage_create(idx, sentence._obj, parse_options)
 
     def __del__(self):
         if hasattr(self, '_obj'):
@@ -499,6 +571,13 @@ class Sentence(object):
             return clg.sentence_num_valid_linkages(self.sent._obj)
 
         def next(self):
+            if self.sent.parse_options.lazy_linkages:
+                # The linkages are extracted as they are iterated over.
+                linkage = Linkage(None, self.sent, self.sent.parse_options._obj)
+                if not linkage:
+                    raise StopIteration()
+                self.num += 1
+                return linkage
             if self.num == clg.sentence_num_valid_linkages(self.sent._obj):
                 raise StopIteration()
             linkage = Linkage(self.num, self.sent, self.sent.parse_options._obj)
@@ -84,6 +84,14 @@ int  parse_options_get_all_short_connectors(Parse_Options opts);
 void parse_options_reset_resources(Parse_Options opts);
 void parse_options_set_use_sat_parser(Parse_Options opts, bool val);
 int parse_options_get_use_sat_parser(Parse_Options opts);
+void parse_options_set_lazy_linkages(Parse_Options opts, bool val);
+bool parse_options_get_lazy_linkages(Parse_Options opts);
+void parse_options_set_parse_forest(Parse_Options opts, bool val);
+bool parse_options_get_parse_forest(Parse_Options opts);
+void parse_options_set_kbest(Parse_Options opts, bool val);
+bool parse_options_get_kbest(Parse_Options opts);
+void parse_options_set_threads(Parse_Options opts, int threads);
+int  parse_options_get_threads(Parse_Options opts);
 
 /**********************************************************************
 *
@@ -128,6 +136,7 @@ int  sentence_link_cost(Sentence sent, int i);
 
 
 Linkage linkage_create(int index, Sentence sent, Parse_Options opts);
+Linkage sentence_next_linkage(Sentence sent, Parse_Options opts);
 void linkage_delete(Linkage linkage);
 
 %typemap(newfree) char * {
@@ -189,6 +198,43 @@ int linkage_link_cost(Linkage linkage);
 double linkage_corpus_cost(Linkage linkage);
 const char * linkage_get_violation_name(Linkage linkage);
 
+/**********************************************************************
+*
+* Functions that access the packed parse forest of a Sentence.
+*
+***********************************************************************/
+
+Parse_forest sentence_get_parse_forest(Sentence sent);
+size_t parse_forest_get_num_nodes(Parse_forest pf);
+size_t parse_forest_get_num_choices(Parse_forest pf);
+size_t parse_forest_get_null_count(Parse_forest pf);
+int parse_forest_get_node_lword(Parse_forest pf, ForestIdx node);
+int parse_forest_get_node_rword(Parse_forest pf, ForestIdx node);
+double parse_forest_get_node_count(Parse_forest pf, ForestIdx node);
+double parse_forest_get_node_cost(Parse_forest pf, ForestIdx node);
+ForestIdx parse_forest_get_node_first_choice(Parse_forest pf, ForestIdx node);
+size_t parse_forest_get_node_num_choices(Parse_forest pf, ForestIdx node);
+ForestIdx parse_forest_get_choice_left(Parse_forest pf, ForestIdx choice);
+ForestIdx parse_forest_get_choice_right(Parse_forest pf, ForestIdx choice);
+int parse_forest_get_choice_word(Parse_forest pf, ForestIdx choice);
+const char * parse_forest_get_choice_word_string(Parse_forest pf, ForestIdx choice);
+double parse_forest_get_choice_disjunct_cost(Parse_forest pf, ForestIdx choice);
+size_t parse_forest_get_choice_num_links(Parse_forest pf, ForestIdx choice);
+int parse_forest_get_choice_link_lword(Parse_forest pf, ForestIdx choice, LinkIdx index);
+int parse_forest_get_choice_link_rword(Parse_forest pf, ForestIdx choice, LinkIdx index);
+const char * parse_forest_get_choice_link_label(Parse_forest pf, ForestIdx choice, LinkIdx index);
+
+%newobject parse_forest_print;
+%typemap(newfree) char * {
+   parse_forest_free_print($1);
+}
+char * parse_forest_print(Parse_forest pf);
+
+// Reset to default.
+%typemap(newfree) char * {
+   free($1);
+}
+
 /* Error-handling facility calls. */
 %rename(_lg_error_formatmsg) lg_error_formatmsg;
 %newobject lg_error_formatmsg;
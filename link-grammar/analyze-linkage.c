@@ -74,8 +74,16 @@ void compute_link_names(Linkage lkg, String_set *sset)
 	size_t i;
 	for (i = 0; i < lkg->num_links; i++)
 	{
-		lkg->link_array[i].link_name = intersect_strings(sset,
-			connector_get_string(lkg->link_array[i].lc),
-			connector_get_string(lkg->link_array[i].rc));
+		lkg->link_array[i].link_name =
+			compute_link_name(lkg->link_array[i].lc, lkg->link_array[i].rc, sset);
 	}
 }
+
+/**
+ * Return the name of the link between the connectors lc and rc.
+ */
+const char * compute_link_name(Connector *lc, Connector *rc, String_set *sset)
+{
+	return intersect_strings(sset, connector_get_string(lc),
+	                         connector_get_string(rc));
+}
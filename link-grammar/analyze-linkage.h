@@ -17,4 +17,5 @@
 #include "link-includes.h"
 
 void compute_link_names(Linkage, String_set *);
+const char * compute_link_name(Connector *, Connector *, String_set *);
 #endif /* _ANALYZE_LINKAGE_H */
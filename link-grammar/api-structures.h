@@ -45,6 +45,7 @@
 #include "dict-structures.h"
 #include "corpus/corpus.h"
 #include "error.h"
+#include "memory-pool.h"
 #include "utilities.h"
 
 struct Cost_Model_s
@@ -93,6 +94,7 @@ struct Parse_Options_s
 	                          no longer than this.  Default = 6 */
 	bool all_short;        /* If true, there can be no connectors that are exempt */
 	bool repeatable_rand;  /* Reset rand number gen after every parse. */
+	int threads;           /* Number of threads for counting parses 1 */
 
 	/* Options governing post-processing */
 	bool perform_pp_prune; /* Perform post-processing-based pruning */
@@ -101,6 +103,14 @@ struct Parse_Options_s
 
 	/* Options governing the generation of linkages. */
 	size_t linkage_limit;  /* The maximum number of linkages processed 100 */
+	bool kbest;            /* Extract the lowest-cost linkages, instead of
+	                          random ones, if there are more than
+	                          linkage_limit of them (default=FALSE) */
+	bool lazy_linkages;    /* Extract and post-process the linkages only
+	                          when sentence_next_linkage() asks for them
+	                          (default=FALSE) */
+	bool parse_forest;     /* Keep the packed parse forest of the sentence
+	                          (default=FALSE) */
 	bool display_morphology;/* if true, print morpho analysis of words */
 };
 
@@ -165,6 +175,9 @@ struct Dictionary_s
 	pp_knowledge  * base_knowledge;    /* Core post-processing rules */
 	pp_knowledge  * hpsg_knowledge;    /* Head-Phrase Structure rules */
 	Connector_set * unlimited_connector_set; /* NULL=everything is unlimited */
+	Connector_enum * connector_enum;   /* NULL=connectors not enumerated */
+	Pp_prune_index * pp_prune_index;   /* NULL=pp_prune by connector names */
+	Disjunct_cache * disjunct_cache;   /* NULL=disjuncts not cached */
 	String_set *    string_set;        /* Set of link names in the dictionary */
 	Word_file *     word_file_header;
 
@@ -199,15 +212,41 @@ struct Parse_info_struct
 	unsigned int   x_table_size;
 	unsigned int   log2_x_table_size;
 	X_table_connector ** x_table;  /* Hash table */
+	Pool_desc *    x_table_pool;   /* X_table_connector elements */
+	Pool_desc *    choice_pool;    /* Parse_choice elements */
+	Kbest_node *   kbest_nodes;    /* k-best state of the parse sets */
 	Parse_set *    parse_set;
 	int            N_words; /* Number of words in current sentence;
 	                           Computed by separate_sentence() */
 
+	/* For abandoning the parse set building (see mk_parse_set()). */
+	Resources      resources;
+	unsigned int   checktimer;
+	bool           aborted;
+
 	/* thread-safe random number state */
 	unsigned int rand_state;
 };
 
 
+/**
+ * The state of the linkage extraction (see process_linkages()). With
+ * lazy linkages, it is kept after sentence_parse(), and the linkages are
+ * extracted when sentence_next_linkage() needs them.
+ */
+typedef struct
+{
+	bool pick_randomly;       /* Extract random linkages */
+	bool pick_kbest;          /* Extract the lowest-cost linkages first */
+	bool need_init;           /* The next linkage is not yet initialized */
+	bool lazy;                /* More linkages may be extracted on demand */
+	size_t itry;              /* Number of extraction tries so far */
+	size_t maxtries;
+	size_t N_invalid_morphism;
+	size_t num_extracted;     /* Linkages in the linkage array */
+	size_t next;              /* Next linkage of sentence_next_linkage() */
+} Linkage_extraction;
+
 struct Sentence_s
 {
 	Dictionary  dict;           /* Words are defined from this dictionary */
@@ -216,6 +255,19 @@ struct Sentence_s
 	Word  *word;                /* Array of words after tokenization */
 	String_set *   string_set;  /* Used for assorted strings */
 
+	/* The disjuncts and connectors of the words, and the wordgraph
+	 * words, are allocated in these pools, and are released at once. */
+	Pool_desc * disjunct_pool;
+	Pool_desc * connector_pool;
+	Pool_desc * gword_pool;
+
+	/* The disjuncts and connectors left after pruning, packed into
+	 * contiguous arrays (see pack_sentence()). */
+	Disjunct *packed_disjuncts;
+	size_t num_packed_disjuncts;
+	Connector *packed_connectors;
+	size_t num_packed_connectors;
+
 	/* Wordgraph stuff. FIXME: typedef for structs. */
 	Gword *wordgraph;            /* Tokenization wordgraph */
 	Gword *last_word;            /* FIXME Last issued word */
@@ -244,6 +296,12 @@ struct Sentence_s
 	Linkage        lnkages;     /* Sorted array of valid & invalid linkages */
 	Postprocessor * postprocessor;
 	Postprocessor * constituent_pp;
+	Linkage_extraction lx;      /* State of the linkage extraction */
+	Parse_forest   parse_forest; /* If requested by the parse options */
+#ifdef USE_PTHREADS
+	Postprocessor ** pp_helper; /* Per-thread post-processing state */
+	size_t num_pp_helpers;
+#endif /* USE_PTHREADS */
 
 	/* parse_info not used by SAT solver */
 	Parse_info     parse_info;  /* Set of parses for the sentence */
@@ -251,6 +309,10 @@ struct Sentence_s
 	/* thread-safe random number state */
 	unsigned int rand_state;
 
+	/* Set by sentence_parse_cancel(), possibly from another thread,
+	 * so it is accessed atomically. */
+	bool cancelled;
+
 #ifdef USE_SAT_SOLVER
 	void *hook;                 /* Hook for the SAT solver */
 #endif /* USE_SAT_SOLVER */
@@ -295,6 +357,13 @@ struct PP_data_s
 
 	bool *visited;                  /* For the depth-first search */
 	size_t vlength;                 /* Length of visited array */
+
+	const pp_link_class **link_class; /* The class of each link */
+	size_t lclength;                /* Length of link_class array */
+	size_t rule_words;              /* Length of the rule bit sets */
+	pp_bits *linkage_rule_bits;     /* Of all the links */
+	pp_bits *domain_rule_bits;      /* Of the group of each domain */
+	size_t drblength;               /* Domains in domain_rule_bits */
 };
 
 /* A new Postprocessor struct is alloc'ed for each sentence. It contains
@@ -312,6 +381,11 @@ struct Postprocessor_s
 	bool q_pruned_rules;       /* don't prune rules more than once in p.p. */
 	String_set *string_set;      /* Link names seen for sentence */
 
+	/* The link names classified so far, hashed by address. The names
+	 * are in the sentence string set, so they are unique. */
+	pp_link_class **link_class;
+	size_t lc_size, lc_count;
+
 	/* Per-linkage state; this data must be reset prior to processing
 	 * each new linkage. */
 	PP_node *pp_node;
@@ -19,6 +19,8 @@
 #ifndef _API_TYPES_H_
 #define _API_TYPES_H_
 
+#include <stdint.h>
+
 #define MAX_TOKEN_LENGTH 250     /* Maximum number of chars in a token */
 
 /* MAX_SENTENCE cannot be more than 65534, because word MAX_SENTENCE+1 is
@@ -30,6 +32,7 @@
 
 /* Widely used private typedefs */
 typedef struct Connector_struct Connector;
+typedef struct Connector_enum_s Connector_enum;
 typedef struct Cost_Model_s Cost_Model;
 typedef struct Domain_s Domain;
 typedef struct DTreeLeaf_s DTreeLeaf;
@@ -38,6 +41,8 @@ typedef struct Image_node_struct Image_node;
 typedef struct Linkage_info_struct Linkage_info;
 typedef struct Parse_info_struct *Parse_info;
 typedef struct Postprocessor_s Postprocessor;
+typedef struct Pp_prune_index_s Pp_prune_index;
+typedef struct Disjunct_cache_s Disjunct_cache;
 typedef struct PP_data_s PP_data;
 typedef struct PP_info_s PP_info;
 typedef struct Regex_node_s Regex_node;
@@ -52,6 +57,7 @@ typedef struct Disjunct_struct Disjunct;
 typedef struct Link_s Link;
 typedef struct List_o_links_struct List_o_links;
 typedef struct Parse_set_struct Parse_set;
+typedef struct Kbest_node_struct Kbest_node;
 typedef struct String_set_s String_set;
 typedef struct Afdict_class_struct Afdict_class;
 typedef struct Word_struct Word;
@@ -62,6 +68,8 @@ typedef struct X_table_connector_struct X_table_connector;
 /* Post-processing structures */
 typedef struct pp_knowledge_s pp_knowledge;
 typedef struct pp_linkset_s pp_linkset;
+typedef struct pp_link_class_s pp_link_class;
+typedef uint64_t pp_bits;              /* Bit sets of rules */
 typedef struct PP_node_struct PP_node;
 
 typedef struct corpus_s Corpus;
@@ -15,6 +15,9 @@
 #include <math.h>
 #include <string.h>
 #include <stdint.h>
+#ifdef USE_PTHREADS
+#include <pthread.h>
+#endif /* USE_PTHREADS */
 
 #include "analyze-linkage.h"
 #include "corpus/corpus.h"
@@ -26,6 +29,7 @@
 #include "extract-links.h"
 #include "fast-match.h"
 #include "linkage.h"
+#include "parse-forest.h"
 #include "post-process.h"
 #include "preparation.h"
 #include "print.h"
@@ -71,9 +75,16 @@ static int VDAL_compare_parse(Linkage l1, Linkage l2)
 	}
 	else if (p1->disjunct_cost > p2->disjunct_cost) return 1;
 	else if (p1->disjunct_cost < p2->disjunct_cost) return -1;
-	else {
+	else if (p1->link_cost != p2->link_cost) {
 		return (p1->link_cost - p2->link_cost);
 	}
+	else {
+		/* Keep the extraction order, whatever the qsort() algorithm.
+		 * Random picks have a negative index (see extract_next_linkage()). */
+		int i1 = (p1->index < 0) ? -p1->index : p1->index;
+		int i2 = (p2->index < 0) ? -p2->index : p2->index;
+		return (i1 - i2);
+	}
 }
 
 #ifdef USE_CORPUS
@@ -126,6 +137,9 @@ Parse_Options parse_options_create(void)
 	po->use_sat_solver = false;
 	po->use_viterbi = false;
 	po->linkage_limit = 100;
+	po->kbest = false;
+	po->lazy_linkages = false;
+	po->parse_forest = false;
 #if defined HAVE_HUNSPELL || defined HAVE_ASPELL
 	po->use_spell_guess = 7;
 #else
@@ -148,6 +162,7 @@ Parse_Options parse_options_create(void)
 	po->perform_pp_prune = true;
 	po->twopass_length = 30;
 	po->repeatable_rand = true;
+	po->threads = 1;
 	po->resources = resources_create();
 	po->use_cluster_disjuncts = false;
 	po->display_morphology = false;
@@ -314,6 +329,50 @@ int parse_options_get_linkage_limit(Parse_Options opts)
 	return opts->linkage_limit;
 }
 
+/**
+ * If true, and the sentence has more linkages than linkage_limit, then
+ * extract the linkage_limit lowest-cost ones, instead of a random
+ * sample of them. The linkages are then also extracted lowest-cost
+ * first, and lazy linkages are returned in the same order as eager
+ * ones.
+ */
+void parse_options_set_kbest(Parse_Options opts, bool dummy)
+{
+	opts->kbest = dummy;
+}
+bool parse_options_get_kbest(Parse_Options opts)
+{
+	return opts->kbest;
+}
+
+/**
+ * If true, sentence_parse() only extracts and post-processes the
+ * linkages until it finds one without violations, and the rest of them
+ * are extracted by sentence_next_linkage(), when it is called.
+ * Unless kbest is set too, lazy linkages are not sorted.
+ */
+void parse_options_set_lazy_linkages(Parse_Options opts, bool dummy)
+{
+	opts->lazy_linkages = dummy;
+}
+bool parse_options_get_lazy_linkages(Parse_Options opts)
+{
+	return opts->lazy_linkages;
+}
+
+/**
+ * If true, sentence_parse() keeps the packed parse forest of the
+ * sentence, for sentence_get_parse_forest().
+ */
+void parse_options_set_parse_forest(Parse_Options opts, bool dummy)
+{
+	opts->parse_forest = dummy;
+}
+bool parse_options_get_parse_forest(Parse_Options opts)
+{
+	return opts->parse_forest;
+}
+
 void parse_options_set_disjunct_cost(Parse_Options opts, double dummy)
 {
 	opts->disjunct_cost = dummy;
@@ -392,6 +451,29 @@ bool parse_options_get_repeatable_rand(Parse_Options opts) {
 	return opts->repeatable_rand;
 }
 
+/**
+ * The number of threads used for pruning and counting the parses of
+ * long sentences, and for post-processing their linkages.
+ * It has no effect if the library has been built without thread support.
+ */
+void parse_options_set_threads(Parse_Options opts, int threads)
+{
+	if (threads < 1)
+	{
+		prt_error("Error: Illegal number of threads: %d\n", threads);
+		return;
+	}
+	opts->threads = threads;
+}
+
+int parse_options_get_threads(Parse_Options opts) {
+	return opts->threads;
+}
+
+/**
+ * The parse time limit, in seconds. It is the elapsed (wall-clock)
+ * time, not the CPU time, so it does not depend on the number of threads.
+ */
 void parse_options_set_max_parse_time(Parse_Options opts, int dummy) {
 	opts->resources->max_parse_time = dummy;
 }
@@ -523,6 +605,170 @@ void partial_init_linkage(Sentence sent, Linkage lkg, unsigned int N_words)
 	lkg->sent = sent;
 }
 
+/**
+ * Post-process the given linkage, and compute its score.
+ * Return false if it has a post-processing violation.
+ */
+static bool post_process_linkage(Postprocessor *pp, Linkage lkg,
+                                 bool twopass, Parse_Options opts)
+{
+	PP_node *ppn;
+	Linkage_info *lifo = &lkg->lifo;
+	bool valid = true;
+
+	ppn = do_post_process(pp, lkg, twopass);
+
+	/* XXX There is no need to set the domain names if we are not
+	 * printing them. However, deferring this until later requires
+	 * a huge code re-org, because pp_data is needed to get the
+	 * domain type array, and pp_data is deleted immediately below.
+	 * Basically, pp_data and pp_node should be a part of the linkage,
+	 * and not part of the Postprocessor struct.
+	 * This costs about 1% performance penalty. */
+	build_type_array(pp);
+	linkage_set_domain_names(pp, lkg);
+
+	post_process_free_data(&pp->pp_data);
+
+	if (NULL != ppn->violation)
+	{
+		valid = false;
+		lifo->N_violations++;
+
+		/* Set the message, only if not set (e.g. by sane_morphism) */
+		if (NULL == lifo->pp_violation_msg)
+			lifo->pp_violation_msg = ppn->violation;
+	}
+
+	linkage_score(lkg, opts);
+	return valid;
+}
+
+/**
+ * A range of linkages to post-process, possibly in a helper thread.
+ */
+typedef struct
+{
+	Sentence sent;
+	Parse_Options opts;
+	Postprocessor *pp;
+	bool twopass;
+	bool *stop;               /* Set by the first range to time out */
+	size_t start, end;
+	size_t next;              /* Where the post-processing has stopped */
+	size_t N_post_processed;
+	size_t N_invalid;
+#ifdef USE_PTHREADS
+	pthread_t thread;
+	bool running;
+#endif /* USE_PTHREADS */
+} pp_range;
+
+/**
+ * Post-process a range of linkages. Each range checks the resources
+ * and the cancellation by itself, and tells the others to stop too
+ * when they are exhausted.
+ */
+static void post_process_range(pp_range *r)
+{
+	Sentence sent = r->sent;
+	size_t in;
+
+	for (in = r->start; in < r->end; in++)
+	{
+		Linkage lkg = &sent->lnkages[in];
+		Linkage_info *lifo = &lkg->lifo;
+
+		if (lifo->discarded || lifo->N_violations) continue;
+
+		if (!post_process_linkage(r->pp, lkg, r->twopass, r->opts))
+			r->N_invalid++;
+		r->N_post_processed++;
+
+		if (9 == in%10)
+		{
+#ifdef USE_PTHREADS
+			if (__atomic_load_n(r->stop, __ATOMIC_RELAXED)) break;
+			if (resources_exhausted_or_cancelled(r->opts->resources, sent))
+			{
+				__atomic_store_n(r->stop, true, __ATOMIC_RELAXED);
+				break;
+			}
+#else
+			if (resources_exhausted_or_cancelled(r->opts->resources, sent))
+				break;
+#endif /* USE_PTHREADS */
+		}
+	}
+	r->next = in;
+}
+
+#ifdef USE_PTHREADS
+/* ============================================================= */
+/**
+ * Multi-threaded post-processing.
+ *
+ * The linkages are independent of each other once extracted, so the
+ * linkage array is divided into consecutive ranges, one per thread,
+ * and each range is post-processed by its own Postprocessor. The
+ * helper Postprocessors share the rules (and their pruning) of the
+ * sentence one, and are kept in the sentence, since the domain names
+ * they set in the linkages reside in their string sets.
+ */
+
+/* Fewer linkages are post-processed faster than the helpers can start. */
+#define MIN_PARALLEL_LINKAGES 64
+
+static void *post_process_helper(void *arg)
+{
+	post_process_range(arg);
+	return NULL;
+}
+
+static size_t num_pp_ranges(Sentence sent, Parse_Options opts)
+{
+#ifdef USE_CORPUS
+	return 1; /* The corpus scoring is not thread-safe. */
+#else
+	size_t nr = opts->threads;
+
+	/* After a timeout, only the first few linkages are post-processed.
+	 * Do it in a single range, so it is the same ones as without
+	 * threads. */
+	if (resources_exhausted_or_cancelled(opts->resources, sent)) return 1;
+
+	if (nr > sent->num_linkages_alloced / (MIN_PARALLEL_LINKAGES/2))
+		nr = sent->num_linkages_alloced / (MIN_PARALLEL_LINKAGES/2);
+	if (sent->num_linkages_alloced < MIN_PARALLEL_LINKAGES) nr = 1;
+	return (0 == nr) ? 1 : nr;
+#endif /* USE_CORPUS */
+}
+
+static Postprocessor *get_pp_helper(Sentence sent, size_t i)
+{
+	if (sent->num_pp_helpers < i)
+	{
+		size_t n = i;
+		sent->pp_helper = realloc(sent->pp_helper, n * sizeof(Postprocessor *));
+		for (size_t h = sent->num_pp_helpers; h < n; h++)
+			sent->pp_helper[h] = post_process_new_helper(sent->postprocessor);
+		sent->num_pp_helpers = n;
+	}
+	return sent->pp_helper[i-1];
+}
+
+static void free_pp_helpers(Sentence sent)
+{
+	for (size_t h = 0; h < sent->num_pp_helpers; h++)
+		post_process_free_helper(sent->pp_helper[h]);
+	free(sent->pp_helper);
+	sent->pp_helper = NULL;
+	sent->num_pp_helpers = 0;
+}
+#else
+#define num_pp_ranges(sent, opts) 1
+#endif /* USE_PTHREADS */
+
 /**
  * This does basic post-processing for all linkages.
  */
@@ -558,64 +804,81 @@ static void post_process_lkgs(Sentence sent, Parse_Options opts)
 
 			post_process_scan_linkage(sent->postprocessor, lkg);
 
-			if ((49 == in%50) && resources_exhausted(opts->resources)) break;
+			if ((49 == in%50) &&
+			    resources_exhausted_or_cancelled(opts->resources, sent)) break;
 		}
 	}
 
 	/* Second pass: actually perform post-processing */
-	for (in=0; in < N_linkages_alloced; in++)
+	size_t nr = num_pp_ranges(sent, opts);
+	pp_range *range = alloca(nr * sizeof(pp_range));
+	bool stop = false;
+
+	/* The helpers share the rule pruning, so do it first. It keeps
+	 * only the rules relevant to the linkages scanned so far, so it
+	 * must wait until there is a linkage to post-process (there may
+	 * be none at the lower null counts). */
+	for (in = 0; in < N_linkages_alloced; in++)
 	{
-		PP_node *ppn;
-		Linkage lkg = &sent->lnkages[in];
-		Linkage_info *lifo = &lkg->lifo;
-
+		Linkage_info *lifo = &sent->lnkages[in].lifo;
 		if (lifo->discarded || lifo->N_violations) continue;
 
-		ppn = do_post_process(sent->postprocessor, lkg, twopass);
+		post_process_prune_rules(sent->postprocessor, twopass);
+		break;
+	}
 
-		/* XXX There is no need to set the domain names if we are not
-		 * printing them. However, deferring this until later requires
-		 * a huge code re-org, because pp_data is needed to get the
-		 * domain type array, and pp_data is deleted immediately below.
-		 * Basically, pp_data and pp_node should be a part of the linkage,
-		 * and not part of the Postprocessor struct.
-		 * This costs about 1% performance penalty. */
-		build_type_array(sent->postprocessor);
-		linkage_set_domain_names(sent->postprocessor, lkg);
+	for (size_t r = 0; r < nr; r++)
+	{
+		range[r] = (pp_range)
+		{
+			.sent = sent, .opts = opts, .twopass = twopass, .stop = &stop,
+			.start = r * N_linkages_alloced / nr,
+			.end = (r + 1) * N_linkages_alloced / nr,
+			.pp = sent->postprocessor,
+		};
+	}
+
+#ifdef USE_PTHREADS
+	for (size_t r = 1; r < nr; r++)
+	{
+		range[r].pp = get_pp_helper(sent, r);
+		range[r].running = (0 == pthread_create(&range[r].thread, NULL,
+		                                        post_process_helper, &range[r]));
+		/* If the thread cannot be created, do it in the main thread. */
+		if (!range[r].running) range[r].pp = sent->postprocessor;
+	}
+#endif /* USE_PTHREADS */
 
-	   post_process_free_data(&sent->postprocessor->pp_data);
+	post_process_range(&range[0]);
 
-		if (NULL != ppn->violation)
+	for (size_t r = 0; r < nr; r++)
+	{
+#ifdef USE_PTHREADS
+		if (range[r].running)
+			pthread_join(range[r].thread, NULL);
+		else if (0 != r)
+			post_process_range(&range[r]);
+#endif /* USE_PTHREADS */
+		N_linkages_post_processed += range[r].N_post_processed;
+		N_valid_linkages -= range[r].N_invalid;
+
+		/* If the timer expired, then we never finished post-processing.
+		 * Mark the remaining sentences as bad, as otherwise strange
+		 * results get reported. */
+		for (in = range[r].next; in < range[r].end; in++)
 		{
+			Linkage lkg = &sent->lnkages[in];
+			Linkage_info *lifo = &lkg->lifo;
+
+			if (lifo->discarded || lifo->N_violations) continue;
+
 			N_valid_linkages--;
 			lifo->N_violations++;
 
 			/* Set the message, only if not set (e.g. by sane_morphism) */
 			if (NULL == lifo->pp_violation_msg)
-				lifo->pp_violation_msg = ppn->violation;
+				lifo->pp_violation_msg = "Timeout during postprocessing";
 		}
-		N_linkages_post_processed++;
-
-		linkage_score(lkg, opts);
-		if ((9 == in%10) && resources_exhausted(opts->resources)) break;
-	}
-
-	/* If the timer expired, then we never finished post-processing.
-	 * Mark the remaining sentences as bad, as otherwise strange
-	 * results get reported. */
-	for (; in < N_linkages_alloced; in++)
-	{
-		Linkage lkg = &sent->lnkages[in];
-		Linkage_info *lifo = &lkg->lifo;
-
-		if (lifo->discarded || lifo->N_violations) continue;
-
-		N_valid_linkages--;
-		lifo->N_violations++;
-
-		/* Set the message, only if not set (e.g. by sane_morphism) */
-		if (NULL == lifo->pp_violation_msg)
-			lifo->pp_violation_msg = "Timeout during postprocessing";
 	}
 
 	print_time(opts, "Postprocessed all linkages");
@@ -643,7 +906,7 @@ static void sort_linkages(Sentence sent, Parse_Options opts)
 
 #ifdef DEBUG
 	/* Skip in case of a timeout - sent->lnkages may be inconsistent then. */
-	if (!resources_exhausted(opts->resources))
+	if (!resources_exhausted_or_cancelled(opts->resources, sent))
 	{
 		/* num_linkages_post_processed sanity check (ONLY). */
 		size_t in;
@@ -680,6 +943,10 @@ Sentence sentence_create(const char *input_string, Dictionary dict)
 	sent->string_set = string_set_create();
 	sent->rand_state = global_rand_state;
 
+	sent->disjunct_pool = pool_new("Disjunct", 2048, sizeof(Disjunct));
+	sent->connector_pool = pool_new("Connector", 4096, sizeof(Connector));
+	sent->gword_pool = pool_new("Gword", 256, sizeof(Gword));
+
 	sent->postprocessor = post_process_new(dict->base_knowledge);
 
 	/* Make a copy of the input */
@@ -741,27 +1008,27 @@ static void free_sentence_words(Sentence sent)
 	for (i = 0; i < sent->length; i++)
 	{
 		free_X_nodes(sent->word[i].x);
-		free_disjuncts(sent->word[i].d);
 		free(sent->word[i].alternatives);
 	}
 	free((void *) sent->word);
 	sent->word = NULL;
 }
 
+/**
+ * Free the wordgraph word arrays. The words themselves are released
+ * with the Gword pool.
+ */
 static void wordgraph_delete(Sentence sent)
 {
 	Gword *w = sent->wordgraph;
 
 	while(NULL != w)
 	{
-		Gword *w_tofree = w;
-
 		free(w->prev);
 		free(w->next);
 		free(w->hier_position);
 		free(w->null_subwords);
 		w = w->chain_next;
-		free(w_tofree);
 	}
 	sent->wordgraph = sent->last_word = NULL;
 }
@@ -795,6 +1062,17 @@ static void gword_set_delete(Gword *w)
 	}
 }
 
+/**
+ * Release the state of the lazy linkage extraction.
+ */
+static void free_linkage_extraction(Sentence sent)
+{
+	Linkage_extraction *lx = &sent->lx;
+
+	memset(lx, 0, sizeof(*lx));
+	lx->need_init = true;
+}
+
 void sentence_delete(Sentence sent)
 {
 	if (!sent) return;
@@ -804,10 +1082,19 @@ void sentence_delete(Sentence sent)
 	wordgraph_delete(sent);
 	word_queue_delete(sent);
 	string_set_delete(sent->string_set);
+	free_linkage_extraction(sent);
+	parse_forest_delete(sent->parse_forest);
 	free_parse_info(sent->parse_info);
 	free_linkages(sent);
+#ifdef USE_PTHREADS
+	free_pp_helpers(sent);
+#endif /* USE_PTHREADS */
 	post_process_free(sent->postprocessor);
 	post_process_free(sent->constituent_pp);
+	free_packed_sentence(sent);
+	pool_delete(sent->disjunct_pool);
+	pool_delete(sent->connector_pool);
+	pool_delete(sent->gword_pool);
 
 	global_rand_state = sent->rand_state;
 	xfree((char *) sent, sizeof(struct Sentence_s));
@@ -848,7 +1135,7 @@ int sentence_num_violations(Sentence sent, LinkageIdx i)
 	if (!sent) return 0;
 
 	if (!sent->lnkages) return 0;
-	if (sent->num_linkages_alloced <= i) return 0; /* bounds check */
+	if (sent->num_linkages_post_processed <= i) return 0; /* bounds check */
 	return sent->lnkages[i].lifo.N_violations;
 }
 
@@ -858,7 +1145,7 @@ double sentence_disjunct_cost(Sentence sent, LinkageIdx i)
 
 	/* The sat solver (currently) fails to fill in link_info */
 	if (!sent->lnkages) return 0.0;
-	if (sent->num_linkages_alloced <= i) return 0.0; /* bounds check */
+	if (sent->num_linkages_post_processed <= i) return 0.0; /* bounds check */
 	return sent->lnkages[i].lifo.disjunct_cost;
 }
 
@@ -868,7 +1155,7 @@ int sentence_link_cost(Sentence sent, LinkageIdx i)
 
 	/* The sat solver (currently) fails to fill in link_info */
 	if (!sent->lnkages) return 0;
-	if (sent->num_linkages_alloced <= i) return 0; /* bounds check */
+	if (sent->num_linkages_post_processed <= i) return 0; /* bounds check */
 	return sent->lnkages[i].lifo.link_cost;
 }
 
@@ -1233,15 +1520,20 @@ bool sane_linkage_morphism(Sentence sent, Linkage lkg, Parse_Options opts)
 }
 #undef D_SLM
 
+/**
+ * Release all the disjuncts of the sentence, including the ones that
+ * have been pruned or copied, at once.
+ */
 static void free_sentence_disjuncts(Sentence sent)
 {
 	size_t i;
 
 	for (i = 0; i < sent->length; ++i)
-	{
-		free_disjuncts(sent->word[i].d);
 		sent->word[i].d = NULL;
-	}
+
+	free_packed_sentence(sent);
+	pool_reuse(sent->disjunct_pool);
+	pool_reuse(sent->connector_pool);
 }
 
 static bool setup_linkages(Sentence sent, fast_matcher_t* mchxt,
@@ -1255,7 +1547,8 @@ static bool setup_linkages(Sentence sent, fast_matcher_t* mchxt,
 	{
 		err_ctxt ec = { sent };
 		err_msgc(&ec, lg_Warn, "Warning: Count overflow.\n"
-			"Considering a random subset of %zu of an unknown and large number of linkages",
+			"Considering %s %zu of an unknown and large number of linkages",
+			opts->kbest ? "the lowest-cost" : "a random subset of",
 			opts->linkage_limit);
 	}
 
@@ -1285,28 +1578,35 @@ static bool setup_linkages(Sentence sent, fast_matcher_t* mchxt,
 }
 
 /**
- * This fills the linkage array with morphologically-acceptable
- * linakges.
+ * Prepare the extraction of the linkages of the parse set.
  */
-static void process_linkages(Sentence sent, bool overflowed, Parse_Options opts)
+static void init_linkage_extraction(Sentence sent, bool overflowed,
+                                    Parse_Options opts)
 {
-	if (0 == sent->num_linkages_found) return;
+	Linkage_extraction *lx = &sent->lx;
 
-   /* Pick random linkages if we get more than what was asked for. */
-	bool pick_randomly = overflowed ||
+	/* Pick random linkages if we get more than what was asked for,
+	 * or the lowest-cost ones if so requested. These are extracted
+	 * lowest-cost first even if all the linkages are extracted, so
+	 * that the lazy and the eager linkages are in the same order. */
+	lx->pick_randomly = overflowed ||
 	    (sent->num_linkages_found != (int) sent->num_linkages_alloced);
+	lx->pick_kbest = opts->kbest;
+	if (lx->pick_kbest) lx->pick_randomly = false;
 
-	Parse_info pi = sent->parse_info;
-	pi->rand_state = sent->rand_state;
-	sent->num_valid_linkages = 0;
-	size_t N_invalid_morphism = 0;
+	lx->need_init = true;
+	lx->lazy = opts->lazy_linkages;
+	lx->itry = 0;
+	lx->N_invalid_morphism = 0;
+	lx->num_extracted = 0;
+	lx->next = 0;
 
-	size_t itry = 0;
-	size_t in = 0;
-	size_t maxtries = sent->num_linkages_alloced;
+	lx->maxtries = sent->num_linkages_alloced;
 
-	/* If we're picking randomly, then try as many as we are allowed. */
-	if (pick_randomly) maxtries = sent->num_linkages_found;
+	/* If we're picking randomly (or the best ones), then try as many
+	 * as we are allowed. */
+	if (lx->pick_randomly || lx->pick_kbest)
+		lx->maxtries = sent->num_linkages_found;
 
 	/* In the case of overflow, which will happen for some long
 	 * sentences, but is particularly common for the amy/ady random
@@ -1318,57 +1618,188 @@ static void process_linkages(Sentence sent, bool overflowed, Parse_Options opts)
 	 * don't over-do it.
 	 */
 #define MAX_TRIES 250000
-	if (MAX_TRIES < maxtries) maxtries = MAX_TRIES;
+	if (MAX_TRIES < lx->maxtries) lx->maxtries = MAX_TRIES;
+
+	sent->parse_info->rand_state = sent->rand_state;
+}
+
+/**
+ * Extract the next morphologically-acceptable linkage into the linkage
+ * array, after the ones that are already there.
+ * Return false if there are no more of them.
+ */
+static bool extract_next_linkage(Sentence sent, Parse_Options opts)
+{
+	Linkage_extraction *lx = &sent->lx;
+	Parse_info pi = sent->parse_info;
+	size_t in = lx->num_extracted;
 
-	bool need_init = true;
-	for (itry=0; itry<maxtries; itry++)
+	if (in >= sent->num_linkages_alloced) return false;
+
+	while (lx->itry < lx->maxtries)
 	{
 		Linkage lkg = &sent->lnkages[in];
 		Linkage_info * lifo = &lkg->lifo;
+		size_t itry = lx->itry++;
 
 		/* Negative values tell extract-links to pick randomly; for
 		 * reproducible-rand, the actual value is the rand seed. */
-		lifo->index = pick_randomly ? -(itry+1) : itry;
+		lifo->index = lx->pick_randomly ? -(itry+1) : itry;
 
-		if (need_init)
+		if (lx->need_init)
 		{
 			partial_init_linkage(sent, lkg, pi->N_words);
-			need_init = false;
+			lx->need_init = false;
+		}
+		if (lx->pick_kbest)
+		{
+			/* The count may be bogus due to an overflow. */
+			if (!extract_kbest_links(lkg, pi))
+			{
+				lx->itry = lx->maxtries;
+				break;
+			}
+		}
+		else
+		{
+			extract_links(lkg, pi);
 		}
-		extract_links(lkg, pi);
 		compute_link_names(lkg, sent->string_set);
 		remove_empty_words(lkg);
 
 		if (sane_linkage_morphism(sent, lkg, opts))
 		{
-			need_init = true;
-			in++;
-			sent->num_valid_linkages ++;
-			if (in >= sent->num_linkages_alloced) break;
-		}
-		else
-		{
-			N_invalid_morphism ++;
-			lkg->num_links = 0;
-			lkg->num_words = pi->N_words;
-			// memset(lkg->link_array, 0, lkg->lasz * sizeof(Link));
-			memset(lkg->chosen_disjuncts, 0, pi->N_words * sizeof(Disjunct *));
+			lx->need_init = true;
+			lx->num_extracted++;
+			return true;
 		}
+
+		lx->N_invalid_morphism ++;
+		lkg->num_links = 0;
+		lkg->num_words = pi->N_words;
+		// memset(lkg->link_array, 0, lkg->lasz * sizeof(Link));
+		memset(lkg->chosen_disjuncts, 0, pi->N_words * sizeof(Disjunct *));
 	}
 
+	return false;
+}
+
+/**
+ * Done extracting linkages.
+ */
+static void finish_linkage_extraction(Sentence sent)
+{
+	Linkage_extraction *lx = &sent->lx;
+
 	/* The last one was alloced, but never actually used. Free it. */
-	if (!need_init) free_linkage(&sent->lnkages[in]);
+	if (!lx->need_init) free_linkage(&sent->lnkages[lx->num_extracted]);
+	lx->need_init = true;
+	lx->lazy = false;
 
 	/* The remainder of the array is garbage; we never filled it in.
 	 * So just pretend that it's shorter than it is */
-	sent->num_linkages_alloced = sent->num_valid_linkages;
+	sent->num_linkages_alloced = lx->num_extracted;
 
 	if (verbosity_level(5))
 	{
 		prt_error("Info: sane_morphism(): %zu of %zu linkages had "
 		          "invalid morphology construction\n",
-		          N_invalid_morphism, sent->num_linkages_alloced);
+		          lx->N_invalid_morphism, sent->num_linkages_alloced);
+	}
+}
+
+/**
+ * This fills the linkage array with morphologically-acceptable
+ * linakges.
+ */
+static void process_linkages(Sentence sent, bool overflowed, Parse_Options opts)
+{
+	if (0 == sent->num_linkages_found) return;
+
+	init_linkage_extraction(sent, overflowed, opts);
+	while (extract_next_linkage(sent, opts))
+		;
+	finish_linkage_extraction(sent);
+
+	sent->num_valid_linkages = sent->lx.num_extracted;
+}
+
+/**
+ * Extract and post-process the next linkage, for lazy linkages.
+ * Return false if there are no more linkages.
+ */
+static bool lazy_process_linkage(Sentence sent, Parse_Options opts)
+{
+	if (!sent->lx.lazy) return false;
+	if (!extract_next_linkage(sent, opts))
+	{
+		finish_linkage_extraction(sent);
+		return false;
+	}
+
+	Linkage lkg = &sent->lnkages[sent->lx.num_extracted - 1];
+	bool valid = (0 == lkg->lifo.N_violations);
+
+	/* Special-case the "amy/ady" morphology handling. */
+	if (valid && !sent->dict->affix_table->anysplit)
+		valid = post_process_linkage(sent->postprocessor, lkg, false, opts);
+
+	sent->num_linkages_post_processed++;
+	if (valid) sent->num_valid_linkages++;
+	return true;
+}
+
+/**
+ * Sort the lazy linkages from linkage k on, so that linkage k is the
+ * one sort_linkages() would put there. With kbest, no linkage that is
+ * not extracted yet has a lower disjunct cost than the next kbest
+ * parsing, so the linkages are extracted until this cost exceeds that
+ * of linkage k. Without kbest, the lazy linkages are left in their
+ * extraction order.
+ */
+static void lazy_sort_linkages(Sentence sent, LinkageIdx k, Parse_Options opts)
+{
+	Linkage_extraction *lx = &sent->lx;
+	double min_cost = 1.0e38; /* Of the valid linkages from k on */
+
+	if (!lx->lazy || !lx->pick_kbest) return;
+	if (0 != sent->rand_state && sent->dict->shuffle_linkages) return;
+
+	for (size_t in = k; in < sent->num_linkages_post_processed; in++)
+	{
+		Linkage_info *lifo = &sent->lnkages[in].lifo;
+		if ((0 == lifo->N_violations) && (lifo->disjunct_cost < min_cost))
+			min_cost = lifo->disjunct_cost;
+	}
+
+	/* The costs are summed differently, hence the margin. */
+	while (min_cost + 1.0e-5 >= kbest_disjunct_cost(sent->parse_info, lx->itry))
+	{
+		if (resources_exhausted_or_cancelled(opts->resources, sent)) break;
+		if (!lazy_process_linkage(sent, opts)) break;
+
+		Linkage_info *lifo =
+			&sent->lnkages[sent->num_linkages_post_processed - 1].lifo;
+		if ((0 == lifo->N_violations) && (lifo->disjunct_cost < min_cost))
+			min_cost = lifo->disjunct_cost;
 	}
+
+	if (k >= sent->num_linkages_post_processed) return;
+	qsort((void *)&sent->lnkages[k], sent->num_linkages_post_processed - k,
+	      sizeof(struct Linkage_s),
+	      (int (*)(const void *, const void *))opts->cost_model.compare_fn);
+}
+
+/**
+ * Return false if a word that must be linked has no disjuncts.
+ */
+static bool all_words_have_disjuncts(Sentence sent)
+{
+	for (size_t w = 0; w < sent->length; w++)
+	{
+		if ((NULL == sent->word[w].d) && !sent->word[w].optional) return false;
+	}
+	return true;
 }
 
 /**
@@ -1395,27 +1826,33 @@ static void process_linkages(Sentence sent, bool overflowed, Parse_Options opts)
  * disjuncts which are not appropriate to continue do_parse() tries with
  * null_count>0. To solve that, we need to restore the original
  * disjuncts of the sentence and call pp_and_power_prune() once again.
+ * The count context and the parse sets of the null_count==0 pass are
+ * then useless, and are dropped.
+ *
+ * Otherwise, the fast matcher and the count context are kept across the
+ * null_count iterations. The counts of a null_count are computed from
+ * the counts of the ranges with smaller null counts, which are already
+ * in the table, so each iteration mostly counts only its new slice.
  */
 static void classic_parse(Sentence sent, Parse_Options opts)
 {
 	fast_matcher_t * mchxt = NULL;
 	count_context_t * ctxt;
 	bool pp_and_power_prune_done = false;
-	Disjunct **disjuncts_copy = NULL;
+	Disjuncts_snapshot *disjuncts_snapshot = NULL;
 	bool is_null_count_0 = (0 == opts->min_null_count);
 	int max_null_count = MIN((int)sent->length, opts->max_null_count);
 
 	/* Build lists of disjuncts */
 	prepare_to_parse(sent, opts);
-	if (resources_exhausted(opts->resources)) return;
-	ctxt = alloc_count_context(sent->length);
+	if (resources_exhausted_or_cancelled(opts->resources, sent)) return;
+	ctxt = alloc_count_context();
 
 	if (is_null_count_0 && (0 < max_null_count))
 	{
-		/* Save the disjuncts in case we need to parse with null_count>0. */
-		disjuncts_copy = alloca(sent->length * sizeof(Disjunct *));
-		for (size_t i = 0; i < sent->length; i++)
-			disjuncts_copy[i] = disjuncts_dup(sent->word[i].d);
+		/* Save the disjunct lists in case we need to parse with
+		 * null_count>0. */
+		disjuncts_snapshot = disjuncts_snapshot_save(sent);
 	}
 
 	/* A parse set may have been already been built for this sentence,
@@ -1441,27 +1878,50 @@ static void classic_parse(Sentence sent, Parse_Options opts)
 					opts->min_null_count = 1; /* Don't optimize for null_count==0. */
 
 				/* We are parsing now with null_count>0, when previously we
-				 * parsed with null_count==0. Restore the save disjuncts. */
-				if (NULL != disjuncts_copy)
+				 * parsed with null_count==0. Restore the saved disjuncts.
+				 * (The pruned ones remain in the sentence pools.) */
+				if (NULL != disjuncts_snapshot)
 				{
-					for (size_t i = 0; i < sent->length; i++)
-					{
-						free_disjuncts(sent->word[i].d);
-						sent->word[i].d = disjuncts_copy[i];
-					}
-					disjuncts_copy = NULL;
+					disjuncts_snapshot_restore(sent, disjuncts_snapshot);
+					disjuncts_snapshot_delete(sent, disjuncts_snapshot);
+					disjuncts_snapshot = NULL;
+
+					/* The counts and parse sets of the previous pass are
+					 * keyed by the connectors just dropped. */
+					reset_count_context(ctxt);
+					free_parse_info(sent->parse_info);
+					sent->parse_info = parse_info_new(sent->length);
 				}
 			}
 			pp_and_power_prune(sent, opts);
 			if (is_null_count_0) opts->min_null_count = 0;
-			if (resources_exhausted(opts->resources)) break;
+			if (resources_exhausted_or_cancelled(opts->resources, sent)) break;
+
+			/* If the null_count==0 pruning has left a word without
+			 * disjuncts, there is no complete linkage. Don't build the
+			 * fast matcher and count for nothing. */
+			if ((0 == nl) && (NULL != disjuncts_snapshot) &&
+			    !all_words_have_disjuncts(sent))
+			{
+				if (verbosity > 0) prt_error("No complete linkages found.\n");
+				continue;
+			}
+
+			pack_sentence(sent);
+			if (NULL == disjuncts_snapshot)
+			{
+				/* The sentence pools now hold only disjuncts that are
+				 * either pruned or superseded by the packed ones. */
+				pool_release(sent->disjunct_pool);
+				pool_release(sent->connector_pool);
+			}
 
 			free_fast_matcher(mchxt);
 			mchxt = alloc_fast_matcher(sent);
 			print_time(opts, "Initialized fast matcher");
 		}
 
-		if (resources_exhausted(opts->resources)) break;
+		if (resources_exhausted_or_cancelled(opts->resources, sent)) break;
 		free_linkages(sent);
 
 		sent->null_count = nl;
@@ -1482,8 +1942,27 @@ static void classic_parse(Sentence sent, Parse_Options opts)
 		print_time(opts, "Counted parses");
 
 		bool ovfl = setup_linkages(sent, mchxt, ctxt, opts);
-		process_linkages(sent, ovfl, opts);
-		post_process_lkgs(sent, opts);
+		if (opts->parse_forest)
+		{
+			parse_forest_delete(sent->parse_forest);
+			sent->parse_forest = parse_forest_new(sent);
+		}
+		if (opts->lazy_linkages && !opts->use_sat_solver &&
+		    (0 < sent->num_linkages_found))
+		{
+			/* Extract only up to the first valid linkage. The rest are
+			 * extracted on demand by sentence_next_linkage(). */
+			init_linkage_extraction(sent, ovfl, opts);
+			while ((0 == sent->num_valid_linkages) &&
+			       lazy_process_linkage(sent, opts))
+				;
+			lazy_sort_linkages(sent, 0, opts);
+		}
+		else
+		{
+			process_linkages(sent, ovfl, opts);
+			post_process_lkgs(sent, opts);
+		}
 
 		if (sent->num_valid_linkages > 0) break;
 		if ((0 == nl) && (0 < max_null_count) && verbosity > 0)
@@ -1494,21 +1973,22 @@ static void classic_parse(Sentence sent, Parse_Options opts)
 		if (PARSE_NUM_OVERFLOW < total) break;
 		//if (sent->num_linkages_found > 0 && nl>0) printf("NUM_LINKAGES_FOUND %d\n", sent->num_linkages_found);
 	}
-	sort_linkages(sent, opts);
+	disjuncts_snapshot_delete(sent, disjuncts_snapshot);
+	free_fast_matcher(mchxt);
+
+	/* Lazy linkages are sorted as they are extracted. */
+	if (!sent->lx.lazy) sort_linkages(sent, opts);
 
-	if (NULL != disjuncts_copy)
-	{
-		for (size_t i = 0; i < sent->length; i++)
-			free_disjuncts(disjuncts_copy[i]);
-	}
 	free_count_context(ctxt);
-	free_fast_matcher(mchxt);
 }
 
 int sentence_parse(Sentence sent, Parse_Options opts)
 {
 	int rc;
 
+	free_linkage_extraction(sent);
+	parse_forest_delete(sent->parse_forest);
+	sent->parse_forest = NULL;
 	sent->num_valid_linkages = 0;
 
 	/* If the sentence has not yet been split, do so now.
@@ -1556,3 +2036,49 @@ int sentence_parse(Sentence sent, Parse_Options opts)
 	}
 	return sent->num_valid_linkages;
 }
+
+/**
+ * Return the next valid linkage of the sentence, or NULL if there are
+ * no more. With the lazy_linkages parse option, the linkages are
+ * extracted and post-processed only when asked for; else this just
+ * iterates over the linkages of sentence_parse(). The returned linkage
+ * belongs to the sentence, as with linkage_create().
+ */
+Linkage sentence_next_linkage(Sentence sent, Parse_Options opts)
+{
+	if (!sent) return NULL;
+	Linkage_extraction *lx = &sent->lx;
+
+	if (opts->use_sat_solver)
+		return linkage_create(lx->next++, sent, opts);
+
+	while (true)
+	{
+		lazy_sort_linkages(sent, lx->next, opts);
+		while (lx->next >= sent->num_linkages_post_processed)
+		{
+			if (resources_exhausted_or_cancelled(opts->resources, sent))
+				return NULL;
+			if (!lazy_process_linkage(sent, opts)) return NULL;
+		}
+
+		LinkageIdx k = lx->next++;
+		if (0 == sent->lnkages[k].lifo.N_violations)
+			return linkage_create(k, sent, opts);
+	}
+}
+
+/**
+ * Cancel the parse of the sentence. It may be called from another
+ * thread while sentence_parse() is running, which then returns soon,
+ * as if the parse had timed out. A cancelled sentence stays cancelled:
+ * it is not parsed again.
+ */
+void sentence_parse_cancel(Sentence sent)
+{
+#ifdef USE_PTHREADS
+	__atomic_store_n(&sent->cancelled, true, __ATOMIC_RELAXED);
+#else
+	sent->cancelled = true;
+#endif /* USE_PTHREADS */
+}
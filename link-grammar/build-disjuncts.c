@@ -14,11 +14,18 @@
 /* stuff for transforming a dictionary entry into a disjunct list */
 
 #include <math.h>
+#ifdef USE_PTHREADS
+#include <pthread.h>
+#endif /* USE_PTHREADS */
+
+#include "api-structures.h"
 #include "build-disjuncts.h"
+#include "connector-enum.h"
 #include "dict-api.h"
 #include "dict-common.h"
 #include "disjunct-utils.h"
 #include "externs.h"
+#include "resources.h"
 #include "string-set.h"
 #include "word-utils.h"
 #include "utilities.h" /* For Win32 compatibility features */
@@ -133,6 +140,8 @@ static Tconnector * build_terminal(Exp * e)
 	return c;
 }
 
+static unsigned int count_clause(Exp *);
+
 /**
  * Build the clause for the expression e.  Does not change e
  */
@@ -264,14 +273,15 @@ GNUC_UNUSED static void print_disjunct_list(Disjunct * c)
  * in the list pointed to by e.  Keep only those whose strings whose
  * direction has the value c.
  */
-static Connector * extract_connectors(Tconnector *e, int c)
+static Connector * extract_connectors(Tconnector *e, int c,
+                                      Pool_desc *connector_pool)
 {
 	Connector *e1;
 	if (e == NULL) return NULL;
 	if (e->dir == c)
 	{
-		e1 = connector_new();
-		e1->next = extract_connectors(e->next,c);
+		e1 = connector_new(connector_pool);
+		e1->next = extract_connectors(e->next, c, connector_pool);
 		e1->multi = e->multi;
 		e1->string = e->string;
 		e1->nearest_word = 0;
@@ -279,26 +289,45 @@ static Connector * extract_connectors(Tconnector *e, int c)
 	}
 	else
 	{
-		return extract_connectors(e->next,c);
+		return extract_connectors(e->next, c, connector_pool);
 	}
 }
 
+/**
+ * Return a new disjunct. Sentence disjuncts are allocated from the
+ * sentence disjunct pool, and are all released with it (see
+ * free_sentence_disjuncts()). Else (sent is NULL) it is allocated with
+ * xalloc(), and has to be freed with free_disjuncts().
+ */
+static Disjunct *disjunct_new(Sentence sent)
+{
+	if (NULL == sent) return (Disjunct *) xalloc(sizeof(Disjunct));
+	return (Disjunct *) pool_alloc(sent->disjunct_pool);
+}
+
+static Pool_desc *connector_pool(Sentence sent)
+{
+	return (NULL == sent) ? NULL : sent->connector_pool;
+}
+
 /**
  * Build a disjunct list out of the clause list c.
  * string is the print name of word that generated this disjunct.
  */
 static Disjunct *
-build_disjunct(Clause * cl, const char * string, double cost_cutoff)
+build_disjunct(Sentence sent, Clause * cl, const char * string,
+               double cost_cutoff)
 {
 	Disjunct *dis, *ndis;
+	Pool_desc *cp = connector_pool(sent);
 	dis = NULL;
 	for (; cl != NULL; cl = cl->next)
 	{
 		if (cl->maxcost <= cost_cutoff)
 		{
-			ndis = (Disjunct *) xalloc(sizeof(Disjunct));
-			ndis->left = reverse(extract_connectors(cl->c, '-'));
-			ndis->right = reverse(extract_connectors(cl->c, '+'));
+			ndis = disjunct_new(sent);
+			ndis->left = reverse(extract_connectors(cl->c, '-', cp));
+			ndis->right = reverse(extract_connectors(cl->c, '+', cp));
 			ndis->string = string;
 			ndis->cost = cl->cost;
 			ndis->next = dis;
@@ -308,19 +337,362 @@ build_disjunct(Clause * cl, const char * string, double cost_cutoff)
 	return dis;
 }
 
-Disjunct * build_disjuncts_for_exp(Exp* exp, const char *word, double cost_cutoff)
+/**
+ * Build the disjuncts of the expression. If sent is not NULL, they are
+ * allocated in the sentence pools.
+ */
+Disjunct * build_disjuncts_for_exp(Sentence sent, Exp* exp, const char *word,
+                                   double cost_cutoff)
 {
 	Clause *c ;
 	Disjunct * dis;
 	/* print_expression(exp);  printf("\n"); */
 	c = build_clause(exp);
 	/* print_clause_list(c); */
-	dis = build_disjunct(c, word, cost_cutoff);
+	dis = build_disjunct(sent, c, word, cost_cutoff);
 	/* print_disjunct_list(dis); */
 	free_clause_list(c);
 	return dis;
 }
 
+/* ======================================================== */
+/*
+ * The disjunct cache.
+ *
+ * The expansion of a dictionary expression into disjuncts is the same
+ * in every sentence, except for the connectors that expression_prune()
+ * deleted from the sentence copy of the expression. So each dictionary
+ * expression is expanded only once, into disjunct templates that are
+ * kept in a per-dictionary cache, keyed by the address of the
+ * expression. The disjuncts of a word are then the templates all of
+ * whose connectors are still in its pruned expression.
+ *
+ * This gives the same disjuncts, in the same order, as the expansion of
+ * the pruned expression: expression_prune() deletes a connector
+ * according to its string and direction only, so it deletes all the
+ * occurrences of that connector in the expressions of a word, and
+ * purge_Exp() then deletes exactly the clauses that contain them.
+ *
+ * The cache is shared by the sentences of all the threads that use the
+ * dictionary. Once added, an entry is never changed.
+ */
+
+#define D_DCACHE 6
+
+#define DISJUNCT_CACHE_INIT_SIZE 512
+/* Expressions with more disjuncts are expanded per sentence; they are
+ * usually pruned a lot, and would take too much cache memory. */
+#define MAX_CACHED_DISJUNCTS 1024
+
+typedef struct
+{
+	const char *string;
+	uint16_t id;                /* Connector enumeration ID */
+	bool multi;
+} Tmpl_connector;
+
+typedef struct
+{
+	double cost;
+	double maxcost;
+	unsigned int con;           /* Index of the first connector */
+	uint16_t num_left;          /* Followed by the right connectors */
+	uint16_t num_right;
+} Tmpl_disjunct;
+
+typedef struct
+{
+	const Exp *exp;             /* The dictionary expression */
+	bool uncached;              /* Too many disjuncts; not expanded */
+	Tmpl_disjunct *dis;
+	unsigned int num_dis;
+	Tmpl_connector *con;        /* The connectors of all the disjuncts */
+	unsigned int num_con;
+} Exp_disjuncts;
+
+struct Disjunct_cache_s
+{
+	const Connector_enum *ce;
+	Exp_disjuncts **table;      /* Open addressing, by expression address */
+	size_t table_size;          /* A power of 2 */
+	size_t num_entries;
+#ifdef USE_PTHREADS
+	pthread_mutex_t mutex;
+#endif /* USE_PTHREADS */
+};
+
+/* The expressions are aligned, so their address low bits are all the
+ * same; the high bits of the product depend on all the address bits. */
+static unsigned int exp_hash(const Exp *e, size_t size)
+{
+	uint64_t h = (uintptr_t) e;
+
+	h *= 0x9E3779B97F4A7C15ULL;
+	return (unsigned int) (h >> 32) & (size-1);
+}
+
+static size_t disjunct_cache_find(const Disjunct_cache *dc, const Exp *e)
+{
+	size_t h = exp_hash(e, dc->table_size);
+
+	while ((NULL != dc->table[h]) && (e != dc->table[h]->exp))
+		h = (h + 1) & (dc->table_size-1);
+	return h;
+}
+
+static void disjunct_cache_grow(Disjunct_cache *dc)
+{
+	Exp_disjuncts **old_table = dc->table;
+	size_t old_size = dc->table_size;
+
+	dc->table_size = (0 == old_size) ? DISJUNCT_CACHE_INIT_SIZE : 2 * old_size;
+	dc->table = xalloc(dc->table_size * sizeof(*dc->table));
+	memset(dc->table, 0, dc->table_size * sizeof(*dc->table));
+
+	for (size_t i = 0; i < old_size; i++)
+	{
+		if (NULL == old_table[i]) continue;
+		dc->table[disjunct_cache_find(dc, old_table[i]->exp)] = old_table[i];
+	}
+
+	if (0 != old_size) xfree(old_table, old_size * sizeof(*old_table));
+}
+
+/**
+ * Create the disjunct cache of a dictionary. The templates use the
+ * connector IDs, so the dictionary connectors must have been enumerated.
+ * Return NULL if they have not been.
+ */
+Disjunct_cache *disjunct_cache_create(Dictionary dict)
+{
+	if (NULL == dict->connector_enum) return NULL;
+
+	Disjunct_cache *dc = xalloc(sizeof(Disjunct_cache));
+	memset(dc, 0, sizeof(Disjunct_cache));
+	dc->ce = dict->connector_enum;
+	disjunct_cache_grow(dc);
+#ifdef USE_PTHREADS
+	pthread_mutex_init(&dc->mutex, NULL);
+#endif /* USE_PTHREADS */
+
+	return dc;
+}
+
+static void exp_disjuncts_delete(Exp_disjuncts *ed)
+{
+	xfree(ed->dis, ed->num_dis * sizeof(*ed->dis));
+	xfree(ed->con, ed->num_con * sizeof(*ed->con));
+	xfree(ed, sizeof(Exp_disjuncts));
+}
+
+void disjunct_cache_delete(Disjunct_cache *dc)
+{
+	if (NULL == dc) return;
+
+	lgdebug(+D_DCACHE, "%zu cached expressions\n", dc->num_entries);
+	for (size_t i = 0; i < dc->table_size; i++)
+	{
+		if (NULL != dc->table[i]) exp_disjuncts_delete(dc->table[i]);
+	}
+	xfree(dc->table, dc->table_size * sizeof(*dc->table));
+#ifdef USE_PTHREADS
+	pthread_mutex_destroy(&dc->mutex);
+#endif /* USE_PTHREADS */
+	xfree(dc, sizeof(Disjunct_cache));
+}
+
+/**
+ * Copy the dir-pointing connectors of the clause into the template
+ * connectors, in the order of the connector lists of build_disjunct().
+ * Return false if a connector is not enumerated.
+ */
+static bool tmpl_connectors(const Connector_enum *ce, Tmpl_connector *tc,
+                            Tconnector *t, int dir, uint16_t *num)
+{
+	if (NULL == t) return true;
+	if (!tmpl_connectors(ce, tc, t->next, dir, num)) return false;
+	if (t->dir != dir) return true;
+
+	Tmpl_connector *c = &tc[(*num)++];
+	c->string = t->string;
+	c->multi = t->multi;
+	c->id = connector_enum_id(ce, t->string);
+	return 0 != c->id;
+}
+
+/**
+ * Expand the dictionary expression into disjunct templates.
+ */
+static Exp_disjuncts *exp_disjuncts_new(const Connector_enum *ce, Exp *exp)
+{
+	Exp_disjuncts *ed = xalloc(sizeof(Exp_disjuncts));
+	memset(ed, 0, sizeof(Exp_disjuncts));
+	ed->exp = exp;
+
+	if (count_clause(exp) > MAX_CACHED_DISJUNCTS)
+	{
+		ed->uncached = true;
+		return ed;
+	}
+
+	Clause *clause = build_clause(exp);
+	for (Clause *cl = clause; cl != NULL; cl = cl->next)
+	{
+		ed->num_dis++;
+		for (Tconnector *t = cl->c; t != NULL; t = t->next)
+			ed->num_con++;
+	}
+	ed->dis = xalloc(ed->num_dis * sizeof(*ed->dis));
+	ed->con = xalloc(ed->num_con * sizeof(*ed->con));
+
+	/* build_disjunct() reverses the clause order. */
+	unsigned int n = ed->num_dis, num_con = 0;
+	for (Clause *cl = clause; cl != NULL; cl = cl->next)
+	{
+		Tmpl_disjunct *td = &ed->dis[--n];
+
+		td->cost = cl->cost;
+		td->maxcost = cl->maxcost;
+		td->con = num_con;
+		td->num_left = td->num_right = 0;
+		if (!tmpl_connectors(ce, &ed->con[num_con], cl->c, '-', &td->num_left) ||
+		    !tmpl_connectors(ce, &ed->con[num_con + td->num_left], cl->c, '+',
+		                     &td->num_right))
+		{
+			ed->uncached = true;
+			break;
+		}
+		num_con += td->num_left + td->num_right;
+	}
+	free_clause_list(clause);
+
+	if (ed->uncached)
+	{
+		xfree(ed->dis, ed->num_dis * sizeof(*ed->dis));
+		xfree(ed->con, ed->num_con * sizeof(*ed->con));
+		ed->num_dis = ed->num_con = 0;
+	}
+
+	return ed;
+}
+
+/**
+ * Return the cached disjunct templates of the given dictionary
+ * expression, expanding it if it is not in the cache yet.
+ */
+static const Exp_disjuncts *disjunct_cache_get(Disjunct_cache *dc,
+                                               Exp *exp)
+{
+	Exp_disjuncts *ed;
+
+#ifdef USE_PTHREADS
+	pthread_mutex_lock(&dc->mutex);
+#endif /* USE_PTHREADS */
+	ed = dc->table[disjunct_cache_find(dc, exp)];
+#ifdef USE_PTHREADS
+	pthread_mutex_unlock(&dc->mutex);
+#endif /* USE_PTHREADS */
+	if (NULL != ed) return ed;
+
+	/* Expand it without holding the lock. If another thread has added
+	 * it meanwhile, use its entry. */
+	Exp_disjuncts *new_ed = exp_disjuncts_new(dc->ce, exp);
+
+#ifdef USE_PTHREADS
+	pthread_mutex_lock(&dc->mutex);
+#endif /* USE_PTHREADS */
+	size_t h = disjunct_cache_find(dc, exp);
+	ed = dc->table[h];
+	if (NULL == ed)
+	{
+		ed = dc->table[h] = new_ed;
+		new_ed = NULL;
+		if (2 * ++dc->num_entries >= dc->table_size) disjunct_cache_grow(dc);
+	}
+#ifdef USE_PTHREADS
+	pthread_mutex_unlock(&dc->mutex);
+#endif /* USE_PTHREADS */
+
+	if (NULL != new_ed) exp_disjuncts_delete(new_ed);
+	return ed;
+}
+
+/**
+ * Set (to 1) or clear (to 0) the live-connector marks of the
+ * connectors of the expression. The mark index of a connector is
+ * twice its ID, plus one if it points to the right.
+ */
+static void mark_live_connectors(const Connector_enum *ce, uint8_t *live,
+                                 Exp *e, uint8_t mark)
+{
+	if (e->type == CONNECTOR_type)
+	{
+		uint16_t id = connector_enum_id(ce, e->u.string);
+		live[2 * id + (e->dir == '+')] = mark;
+		return;
+	}
+
+	for (E_list *l = e->u.l; l != NULL; l = l->next)
+		mark_live_connectors(ce, live, l->e, mark);
+}
+
+static Connector *tmpl_connector_list(Pool_desc *connector_pool,
+                                      const Tmpl_connector *tc, size_t num)
+{
+	Connector *head = NULL, **tail = &head;
+
+	for (size_t i = 0; i < num; i++)
+	{
+		Connector *c = connector_new(connector_pool);
+		c->multi = tc[i].multi;
+		c->string = tc[i].string;
+		*tail = c;
+		tail = &c->next;
+	}
+	return head;
+}
+
+/**
+ * Build the disjuncts of the cached templates whose connectors are all
+ * marked as live.
+ */
+static Disjunct *build_disjuncts_from_cache(Sentence sent,
+                                            const Exp_disjuncts *ed,
+                                            const uint8_t *live,
+                                            const char *string,
+                                            double cost_cutoff)
+{
+	Disjunct *head = NULL, **tail = &head;
+
+	for (size_t i = 0; i < ed->num_dis; i++)
+	{
+		const Tmpl_disjunct *td = &ed->dis[i];
+		const Tmpl_connector *tc = &ed->con[td->con];
+		size_t n;
+
+		if (td->maxcost > cost_cutoff) continue;
+
+		for (n = 0; n < td->num_left; n++)
+			if (!live[2 * tc[n].id]) break;
+		if (n < td->num_left) continue;
+		for (; n < (size_t)(td->num_left + td->num_right); n++)
+			if (!live[2 * tc[n].id + 1]) break;
+		if (n < (size_t)(td->num_left + td->num_right)) continue;
+
+		Disjunct *d = disjunct_new(sent);
+		d->left = tmpl_connector_list(sent->connector_pool, tc, td->num_left);
+		d->right = tmpl_connector_list(sent->connector_pool,
+		                               tc + td->num_left, td->num_right);
+		d->string = string;
+		d->cost = td->cost;
+		*tail = d;
+		tail = &d->next;
+	}
+	*tail = NULL;
+
+	return head;
+}
+
 #if DEBUG
 /* There is a much better print_expression elsewhere
  * This one is for low-level debug. */
@@ -466,6 +838,7 @@ X_node * build_word_expressions(Sentence sent, const Gword *w, const char *s)
 		y->next = x;
 		x = y;
 		x->exp = copy_Exp(dn->exp);
+		x->dict_exp = dn->exp;
 		if (NULL == s)
 		{
 			x->string = dn->string;
@@ -491,21 +864,54 @@ X_node * build_word_expressions(Sentence sent, const Gword *w, const char *s)
 /**
  * Turn sentence expressions into disjuncts.
  * Sentence expressions must have been built, before calling this routine.
+ * If the parse gets abandoned meanwhile (according to r), the remaining
+ * words are left without disjuncts.
  */
-void build_sentence_disjuncts(Sentence sent, double cost_cutoff)
+void build_sentence_disjuncts(Sentence sent, double cost_cutoff, Resources r)
 {
 	Disjunct * d;
 	X_node * x;
 	size_t w;
+	Disjunct_cache *dc = sent->dict->disjunct_cache;
+	uint8_t *live = NULL;
+	size_t live_size = 0;
+
+	if (NULL != dc)
+	{
+		live_size = 2 * dc->ce->num_id;
+		live = xalloc(live_size);
+		memset(live, 0, live_size);
+	}
+
 	for (w = 0; w < sent->length; w++)
 	{
 		d = NULL;
 		for (x = sent->word[w].x; x != NULL; x = x->next)
 		{
-			Disjunct *dx = build_disjuncts_for_exp(x->exp, x->string, cost_cutoff);
+			Disjunct *dx;
+			const Exp_disjuncts *ed = NULL;
+
+			if ((NULL != dc) && (NULL != x->dict_exp))
+				ed = disjunct_cache_get(dc, x->dict_exp);
+
+			if ((NULL != ed) && !ed->uncached)
+			{
+				mark_live_connectors(dc->ce, live, x->exp, 1);
+				dx = build_disjuncts_from_cache(sent, ed, live, x->string,
+				                                cost_cutoff);
+				mark_live_connectors(dc->ce, live, x->exp, 0);
+			}
+			else
+			{
+				dx = build_disjuncts_for_exp(sent, x->exp, x->string, cost_cutoff);
+			}
 			word_record_in_disjunct(x->word, dx);
 			d = catenate_disjuncts(dx, d);
 		}
 		sent->word[w].d = d;
+
+		if (resources_exhausted_or_cancelled(r, sent)) break;
 	}
+
+	if (NULL != live) xfree(live, live_size);
 }
@@ -17,12 +17,15 @@
 #include "api-types.h"
 #include "structures.h"
 
-void build_sentence_disjuncts(Sentence sent, double cost_cutoff);
+void build_sentence_disjuncts(Sentence sent, double cost_cutoff, Resources r);
 X_node *   build_word_expressions(Sentence, const Gword *, const char *);
-Disjunct * build_disjuncts_for_exp(Exp*, const char*, double cost_cutoff);
+Disjunct * build_disjuncts_for_exp(Sentence, Exp*, const char*, double cost_cutoff);
 
 unsigned int count_disjunct_for_dict_node(Dict_node *dn);
 
+Disjunct_cache * disjunct_cache_create(Dictionary);
+void disjunct_cache_delete(Disjunct_cache *);
+
 #ifdef DEBUG
 void prt_exp(Exp *, int);
 void prt_exp_mem(Exp *, int);
@@ -0,0 +1,294 @@
+/*************************************************************************/
+/* Copyright (c) 2017 Linas Vepstas                                      */
+/* All rights reserved                                                   */
+/*                                                                       */
+/* Use of the link grammar parsing system is subject to the terms of the */
+/* license set forth in the LICENSE file included with this software.    */
+/* This license allows free redistribution and use in source and binary  */
+/* forms, with or without modification, subject to certain conditions.   */
+/*                                                                       */
+/*************************************************************************/
+
+#include <stdlib.h>
+#include <string.h>
+
+#include "connector-enum.h"
+#include "externs.h"
+#include "utilities.h"
+
+/*
+ * The connector strings of a file dictionary are all in its string-set,
+ * so each distinct connector string has a unique address. At the end of
+ * the dictionary load, each of them gets a small integer ID, and the
+ * match of every pair of them (with the same upper-case part) is
+ * computed once. At sentence preparation, the connectors get their IDs
+ * (see set_connector_ids()), and the pruning and the fast matcher then
+ * look up the precomputed match instead of comparing the strings.
+ *
+ * Connectors with strings that are not in the dictionary string-set
+ * (e.g. ones from the SQL dictionary or the corpus) get ID 0, and are
+ * matched by comparing their strings, as before.
+ */
+
+#define D_CENUM 6
+
+#define ID_TABLE_INIT_SIZE 1024
+#define MAX_MATCH_BITS (1<<26)  /* 8MB of match matrices */
+
+static unsigned int id_table_hash(const char *s, size_t size)
+{
+	uintptr_t h = (uintptr_t) s;
+
+	h ^= h >> 17;
+	h *= 0x9E3779B1;
+	return (unsigned int) (h ^ (h >> 15)) & (size-1);
+}
+
+/**
+ * Return the ID table slot of the given string.
+ * The slot key is either the string, or NULL if it is not in the table.
+ */
+static size_t id_table_find(const Connector_enum *ce, const char *s)
+{
+	size_t h = id_table_hash(s, ce->id_table_size);
+
+	while ((NULL != ce->id_table_key[h]) && (s != ce->id_table_key[h]))
+		h = (h + 1) & (ce->id_table_size-1);
+	return h;
+}
+
+static void id_table_grow(Connector_enum *ce)
+{
+	const char **old_key = ce->id_table_key;
+	uint16_t *old_id = ce->id_table_id;
+	size_t old_size = ce->id_table_size;
+
+	ce->id_table_size = (0 == old_size) ? ID_TABLE_INIT_SIZE : 2 * old_size;
+	ce->id_table_key = xalloc(ce->id_table_size * sizeof(*ce->id_table_key));
+	ce->id_table_id = xalloc(ce->id_table_size * sizeof(*ce->id_table_id));
+	memset(ce->id_table_key, 0, ce->id_table_size * sizeof(*ce->id_table_key));
+
+	for (size_t i = 0; i < old_size; i++)
+	{
+		if (NULL == old_key[i]) continue;
+		size_t h = id_table_find(ce, old_key[i]);
+		ce->id_table_key[h] = old_key[i];
+		ce->id_table_id[h] = old_id[i];
+	}
+
+	if (0 != old_size)
+	{
+		xfree(old_key, old_size * sizeof(*old_key));
+		xfree(old_id, old_size * sizeof(*old_id));
+	}
+}
+
+/**
+ * Add the given connector string, if it is not already there.
+ * Return false if there are too many connectors to enumerate.
+ */
+static bool connector_enum_add(Connector_enum *ce, const char *s)
+{
+	if (2 * ce->num_id >= ce->id_table_size) id_table_grow(ce);
+
+	size_t h = id_table_find(ce, s);
+	if (NULL != ce->id_table_key[h]) return true;
+	if (MAX_CONNECTOR_ID < ce->num_id) return false;
+
+	ce->id_table_key[h] = s;
+	ce->id_table_id[h] = ce->num_id++;
+	return true;
+}
+
+/**
+ * Return the upper-case part of a connector string, and its length.
+ */
+static const char *uc_part(const char *s, size_t *len)
+{
+	if (islower((int) *s)) s++; /* ignore head-dependent indicator */
+
+	const char *t = s;
+	while (isupper((int) *t)) t++;
+	*len = t - s;
+	return s;
+}
+
+static int uc_part_cmp(const char *s1, const char *s2)
+{
+	size_t len1, len2;
+	const char *uc1 = uc_part(s1, &len1);
+	const char *uc2 = uc_part(s2, &len2);
+
+	if (len1 != len2) return (len1 < len2) ? -1 : 1;
+	return strncmp(uc1, uc2, len1);
+}
+
+typedef struct
+{
+	const char *string;
+	uint16_t id;
+} Id_string;
+
+static int id_cmp_by_uc_part(const void *a, const void *b)
+{
+	const Id_string *is1 = a;
+	const Id_string *is2 = b;
+
+	int cmp = uc_part_cmp(is1->string, is2->string);
+	if (0 != cmp) return cmp;
+	return (is1->id < is2->id) ? -1 : (is1->id > is2->id);
+}
+
+/**
+ * Group the connectors by their upper-case part, and compute the match
+ * matrix of each group.
+ * Return false if the matrices would be too big.
+ */
+static bool compute_match_bits(Connector_enum *ce)
+{
+	size_t n = ce->num_id - 1;
+	Id_string *sorted = xalloc(n * sizeof(*sorted));
+
+	for (size_t i = 0; i < n; i++)
+	{
+		sorted[i].id = i + 1;
+		sorted[i].string = ce->string[i + 1];
+	}
+	qsort(sorted, n, sizeof(*sorted), id_cmp_by_uc_part);
+
+	/* Assign the groups, and find the total matrix size. */
+	size_t nbits = 0;
+	unsigned int group = 0;
+	for (size_t start = 0, end; start < n; start = end)
+	{
+		for (end = start + 1; end < n; end++)
+		{
+			if (0 != uc_part_cmp(sorted[start].string, sorted[end].string))
+				break;
+		}
+
+		size_t group_size = end - start;
+		for (size_t i = start; i < end; i++)
+		{
+			Connector_desc *d = &ce->desc[sorted[i].id];
+			d->group = group;
+			d->index = i - start;
+			d->row = nbits + d->index * group_size;
+		}
+		nbits += group_size * group_size;
+		group++;
+	}
+
+	if (MAX_MATCH_BITS < nbits)
+	{
+		lgdebug(+D_CENUM, "Match matrices too big (%zu bits)\n", nbits);
+		xfree(sorted, n * sizeof(*sorted));
+		return false;
+	}
+
+	ce->match_bits_size = (nbits + 7) / 8;
+	ce->match_bits = xalloc(ce->match_bits_size);
+	memset(ce->match_bits, 0, ce->match_bits_size);
+
+	for (size_t start = 0, end; start < n; start = end)
+	{
+		unsigned int g = ce->desc[sorted[start].id].group;
+		for (end = start + 1; end < n; end++)
+			if (g != ce->desc[sorted[end].id].group) break;
+
+		for (size_t i = start; i < end; i++)
+		{
+			for (size_t j = start; j < end; j++)
+			{
+				if (!easy_match(sorted[i].string, sorted[j].string)) continue;
+				uint32_t bit = ce->desc[sorted[i].id].row + (j - start);
+				ce->match_bits[bit >> 3] |= 1 << (bit & 7);
+			}
+		}
+	}
+
+	lgdebug(+D_CENUM, "%zu connectors in %u groups, %zu match bytes\n",
+	        n, group, ce->match_bits_size);
+	xfree(sorted, n * sizeof(*sorted));
+	return true;
+}
+
+/**
+ * Enumerate the connectors of the given dictionary expression list.
+ * Return NULL if there are no connectors or too many of them.
+ */
+Connector_enum *connector_enum_create(Exp *exp_list)
+{
+	Connector_enum *ce = xalloc(sizeof(Connector_enum));
+	memset(ce, 0, sizeof(Connector_enum));
+	ce->num_id = 1; /* ID 0 is reserved */
+
+	for (Exp *e = exp_list; NULL != e; e = e->next)
+	{
+		if ((CONNECTOR_type != e->type) || (NULL == e->u.string)) continue;
+		if (!connector_enum_add(ce, e->u.string))
+		{
+			lgdebug(+D_CENUM, "Too many connectors; not enumerated\n");
+			connector_enum_delete(ce);
+			return NULL;
+		}
+	}
+
+	if (1 == ce->num_id)
+	{
+		connector_enum_delete(ce);
+		return NULL;
+	}
+
+	ce->string = xalloc(ce->num_id * sizeof(*ce->string));
+	ce->desc = xalloc(ce->num_id * sizeof(*ce->desc));
+	ce->str_hash = xalloc(ce->num_id * sizeof(*ce->str_hash));
+	ce->string[0] = NULL;
+	memset(&ce->desc[0], 0, sizeof(*ce->desc));
+	ce->str_hash[0] = 0;
+	for (size_t i = 0; i < ce->id_table_size; i++)
+	{
+		if (NULL == ce->id_table_key[i]) continue;
+		uint16_t id = ce->id_table_id[i];
+		ce->string[id] = ce->id_table_key[i];
+		ce->str_hash[id] = string_hash(ce->id_table_key[i]);
+	}
+
+	if (!compute_match_bits(ce))
+	{
+		connector_enum_delete(ce);
+		return NULL;
+	}
+	return ce;
+}
+
+void connector_enum_delete(Connector_enum *ce)
+{
+	if (NULL == ce) return;
+
+	if (NULL != ce->string)
+	{
+		xfree(ce->string, ce->num_id * sizeof(*ce->string));
+		xfree(ce->desc, ce->num_id * sizeof(*ce->desc));
+		xfree(ce->str_hash, ce->num_id * sizeof(*ce->str_hash));
+		xfree(ce->match_bits, ce->match_bits_size);
+	}
+	if (0 != ce->id_table_size)
+	{
+		xfree(ce->id_table_key, ce->id_table_size * sizeof(*ce->id_table_key));
+		xfree(ce->id_table_id, ce->id_table_size * sizeof(*ce->id_table_id));
+	}
+	xfree(ce, sizeof(Connector_enum));
+}
+
+/**
+ * Return the ID of the given connector string, or 0 if it is not a
+ * dictionary connector string.
+ */
+uint16_t connector_enum_id(const Connector_enum *ce, const char *s)
+{
+	size_t h = id_table_find(ce, s);
+
+	if (NULL == ce->id_table_key[h]) return 0;
+	return ce->id_table_id[h];
+}
@@ -0,0 +1,96 @@
+/*************************************************************************/
+/* Copyright (c) 2017 Linas Vepstas                                      */
+/* All rights reserved                                                   */
+/*                                                                       */
+/* Use of the link grammar parsing system is subject to the terms of the */
+/* license set forth in the LICENSE file included with this software.    */
+/* This license allows free redistribution and use in source and binary  */
+/* forms, with or without modification, subject to certain conditions.   */
+/*                                                                       */
+/*************************************************************************/
+
+#ifndef _CONNECTOR_ENUM_H_
+#define _CONNECTOR_ENUM_H_
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "api-types.h"
+#include "dict-structures.h"
+#include "structures.h"
+#include "word-utils.h"
+
+/* Connector IDs are 16-bit. ID 0 means "not enumerated". */
+#define MAX_CONNECTOR_ID UINT16_MAX
+
+typedef struct
+{
+	uint16_t group;         /* Same for connectors with the same uc part */
+	uint16_t index;         /* Position in the group */
+	uint32_t row;           /* Match-bits offset of this connector's row */
+} Connector_desc;
+
+/**
+ * The enumeration of the connector strings of a dictionary.
+ * Connectors can match only if their upper-case parts are the same, so
+ * the connectors are grouped by their upper-case part, and the match
+ * results are precomputed per group, as a bit matrix.
+ * It is read-only after its creation, and can be shared by threads.
+ */
+struct Connector_enum_s
+{
+	size_t num_id;            /* Number of IDs, including the unused 0 */
+	const char **string;      /* ID -> connector string */
+	Connector_desc *desc;     /* ID -> match matrix position */
+	unsigned int *str_hash;   /* ID -> string_hash() of the string */
+	uint8_t *match_bits;      /* The per-group match matrices */
+	size_t match_bits_size;   /* In bytes */
+
+	/* Connector string (pointer) -> ID (open addressing) */
+	const char **id_table_key;
+	uint16_t *id_table_id;
+	size_t id_table_size;     /* A power of 2 */
+};
+
+Connector_enum *connector_enum_create(Exp *exp_list);
+void connector_enum_delete(Connector_enum *);
+uint16_t connector_enum_id(const Connector_enum *, const char *);
+
+/**
+ * Return true iff the connectors whose IDs are id1 and id2 match.
+ * The result is the same as that of easy_match() for their strings.
+ */
+static inline bool connector_enum_match(const Connector_enum *ce,
+                                        unsigned int id1, unsigned int id2)
+{
+	const Connector_desc *d1 = &ce->desc[id1];
+	const Connector_desc *d2 = &ce->desc[id2];
+
+	if (d1->group != d2->group) return false;
+	uint32_t bit = d1->row + d2->index;
+	return 0 != (ce->match_bits[bit >> 3] & (1 << (bit & 7)));
+}
+
+/**
+ * Return true iff the connectors c1 and c2 match.
+ * If both of them have been enumerated, use the match matrix.
+ */
+static inline bool connectors_match(const Connector_enum *ce,
+                                    const Connector *c1, const Connector *c2)
+{
+	if ((0 != c1->id) && (0 != c2->id))
+		return connector_enum_match(ce, c1->id, c2->id);
+	return easy_match(c1->string, c2->string);
+}
+
+/**
+ * Return true iff the upper-case parts of c1 and c2 are the same.
+ * Valid only if both connectors have been enumerated.
+ */
+static inline bool connector_enum_uc_eq(const Connector_enum *ce,
+                                        const Connector *c1, const Connector *c2)
+{
+	return ce->desc[c1->id].group == ce->desc[c2->id].group;
+}
+
+#endif /* _CONNECTOR_ENUM_H_ */
@@ -24,7 +24,7 @@
 static Disjunct * build_disjuncts_for_dict_node(Dict_node *dn)
 {
    Disjunct *dj;
-   dj = build_disjuncts_for_exp(dn->exp, dn->string, MAX_CONNECTOR_COST);
+   dj = build_disjuncts_for_exp(NULL, dn->exp, dn->string, MAX_CONNECTOR_COST);
    /* print_disjunct_list(dj); */
    return dj;
 }
@@ -163,7 +163,7 @@ int main (int argc, char * argv[])
 				cnt ++;
 			}
 			dj_union = catenate_disjuncts(dj_union, dj);
-			dj_union = eliminate_duplicate_disjuncts(dj_union);
+			dj_union = eliminate_duplicate_disjuncts(dj_union, NULL);
 
 			int ucnt = count_disjuncts(dj_union);
 			if (cnt != ucnt) do_keep = 1;
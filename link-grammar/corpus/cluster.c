@@ -277,7 +277,7 @@ Disjunct * lg_cluster_get_disjuncts(Cluster *c, const char * wrd)
 
 		/* Building expressions */
 		e = make_exp(djs, cost);
-		dj = build_disjuncts_for_exp(e, wrd, MAX_CONNECTOR_COST);
+		dj = build_disjuncts_for_exp(NULL, e, wrd, MAX_CONNECTOR_COST);
 		djl = catenate_disjuncts(dj, djl);
 		free_exp(e);
 	}
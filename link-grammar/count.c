@@ -12,11 +12,17 @@
 /*************************************************************************/
 
 #include <limits.h>
+#ifdef USE_PTHREADS
+#include <pthread.h>
+#endif /* USE_PTHREADS */
+
 #include "link-includes.h"
 #include "api-structures.h"
 #include "count.h"
 #include "disjunct-utils.h"
+#include "externs.h"
 #include "fast-match.h"
+#include "memory-pool.h"
 #include "prune.h"
 #include "resources.h"
 #include "structures.h"
@@ -24,16 +30,47 @@
 
 /* This file contains the exhaustive search algorithm. */
 
+#define D_COUNT 6 /* Debug level for this file */
+
 typedef struct Table_connector_s Table_connector;
 struct Table_connector_s
 {
-	Table_connector  *next;
 	Connector        *le, *re;
 	Count_bin        count;
 	short            lw, rw;
 	unsigned short   null_count;
+	bool             used;  /* Looked up since the last rehash */
 };
 
+/**
+ * A table bucket holds the key of its entry, so the lookups compare the
+ * keys in the bucket array, and access only the entry that is found.
+ * The key is made of the indices of the packed connectors (see
+ * pack_sentence()) and of the words and null count (see table_key()).
+ * It is unique for sentences of up to 2^20 connectors; otherwise, and
+ * for an entry whose key is not yet stored (it is 0 until then when
+ * counting in parallel), the entry itself is compared.
+ */
+typedef struct
+{
+	uint64_t         key;
+	Table_connector  *entry;
+} Table_bucket;
+
+typedef struct
+{
+	Connector        *c;
+	short            w;
+	unsigned short   null_count;
+} Zero_span;
+
+#ifdef USE_PTHREADS
+typedef struct count_helper_s count_helper_t;
+#endif /* USE_PTHREADS */
+
+static Count_bin do_count(fast_matcher_t *, count_context_t *,
+                          int, int, Connector *, Connector *, int);
+
 struct count_context_s
 {
 	Word *  local_sent;
@@ -41,75 +78,332 @@ struct count_context_s
 	bool    islands_ok;
 	bool    null_links;
 	bool    exhausted;
-	int     checktimer;  /* Avoid excess system calls */
-	int     table_size;
-	int     log2_table_size;
-	Table_connector ** table;
+	unsigned int checktimer;  /* Avoid excess system calls */
+	unsigned int table_size;
+	int     table_available; /* Stores left before the table grows */
+	Table_bucket * table;
+	Pool_desc * table_pool;
+	const Connector *connector_base; /* The packed sentence connectors */
 	Resources current_resources;
+	Sentence current_sent; /* For checking cancellation */
+
+	/* Bounded-memory counting (see evict_table_entries()). */
+	size_t  max_table_memory; /* 0 if unbounded */
+	bool    evicted;     /* Some of the counts have been dropped */
+	bool    table_full;  /* The table had no room at the memory limit */
+	Table_connector *free_entries; /* Evicted entries, for reuse */
+
+	/* Known-zero spans (see zero_span_known()). */
+	Zero_span *zero_span;
+	unsigned int zero_span_size;
+
+	/* Multi-threaded counting (see do_parse()). */
+	int     thread_id;   /* 0 for the main thread */
+#ifdef USE_PTHREADS
+	bool    parallel;    /* The table is currently shared with helpers */
+	bool    aborted;     /* A helper gave up; its results are void */
+	bool    stop;        /* Main thread: tell the helpers to quit */
+	count_context_t *main_ctxt;
+	count_helper_t *helper;
+	int     num_helpers;
+#endif /* USE_PTHREADS */
 };
 
+/* The table is grown when it becomes more than half full. Open
+ * addressing with linear probing degrades quickly above that. */
+#define MAX_TABLE_LOAD(size) ((size) / 2)
+
+/* Never start with fewer buckets than this. */
+#define MIN_TABLE_SIZE (1U << 12)
+
+/* The known-zero span cache has one slot per this many table buckets. */
+#define ZERO_SPAN_RATIO 4
+
+/* The known-zero facts are tracked per null count, up to 63. */
+#define ZERO_SPAN_BIT(n) (((n) < 64) ? ((uint64_t)1 << (n)) : 0)
+
+/* Evicted entries are chained through their first bytes. */
+#define FREE_NEXT(t) (*(Table_connector **)(t))
+
+/* When counting in parallel, the table buckets are written with
+ * compare-and-swap, and read with an acquire load, so that a table
+ * entry is seen only after its count has been fully stored. */
+#ifdef USE_PTHREADS
+#define table_bucket(ctxt, h) __atomic_load_n(&(ctxt)->table[h].entry, __ATOMIC_ACQUIRE)
+#define table_bucket_key(ctxt, h) __atomic_load_n(&(ctxt)->table[h].key, __ATOMIC_RELAXED)
+#else
+#define table_bucket(ctxt, h) ((ctxt)->table[h].entry)
+#define table_bucket_key(ctxt, h) ((ctxt)->table[h].key)
+#endif /* USE_PTHREADS */
+
+static inline uint64_t table_key(const count_context_t *ctxt,
+                                 int lw, int rw,
+                                 const Connector *le, const Connector *re,
+                                 unsigned int null_count)
+{
+	uint64_t lei = connector_index(ctxt->connector_base, le) & 0xFFFFF;
+	uint64_t rei = connector_index(ctxt->connector_base, re) & 0xFFFFF;
+
+	return (lei << 44) | (rei << 24) | ((uint64_t)(null_count & 0xFF) << 16) |
+	       ((uint64_t)(rw & 0xFF) << 8) | (uint64_t)((lw + 1) & 0xFF);
+}
+
+static inline bool table_entry_is(const Table_connector *t,
+                                  int lw, int rw,
+                                  const Connector *le, const Connector *re,
+                                  unsigned int null_count)
+{
+	return (t->lw == lw) && (t->rw == rw) && (t->le == le) && (t->re == re)
+	       && (t->null_count == null_count);
+}
+
+#ifdef USE_PTHREADS
+static void free_helpers(count_context_t *);
+#endif /* USE_PTHREADS */
+
 static void free_table(count_context_t *ctxt)
 {
-	int i;
-	Table_connector *t, *x;
+#ifdef USE_PTHREADS
+	free_helpers(ctxt);
+#endif /* USE_PTHREADS */
+	pool_delete(ctxt->table_pool);
+	ctxt->table_pool = NULL;
+	xfree(ctxt->table, ctxt->table_size * sizeof(Table_bucket));
+	ctxt->table = NULL;
+	xfree(ctxt->zero_span, ctxt->zero_span_size * sizeof(Zero_span));
+	ctxt->zero_span = NULL;
+	ctxt->zero_span_size = 0;
+	ctxt->table_size = 0;
+	ctxt->table_available = 0;
+	ctxt->free_entries = NULL;
+	ctxt->evicted = false;
+	ctxt->table_full = false;
+}
+
+static void alloc_table_buckets(count_context_t *ctxt, unsigned int size)
+{
+	ctxt->table_size = size;
+	ctxt->table_available = MAX_TABLE_LOAD(size);
+	ctxt->table = xalloc(size * sizeof(Table_bucket));
+	memset(ctxt->table, 0, size * sizeof(Table_bucket));
+}
+
+/**
+ * The peak memory used by a full table with the given number of
+ * buckets. This includes a second bucket array, since the old one is
+ * freed only after the entries are rehashed into the new one.
+ */
+static size_t table_memory(unsigned int size)
+{
+	return 2 * size * sizeof(Table_bucket) +
+	       MAX_TABLE_LOAD(size) * sizeof(Table_connector);
+}
+
+/**
+ * Size the table according to the number of connectors in the
+ * (already pruned) sentence. The number of table entries needed is
+ * typically one to a few times the number of connectors, and it can
+ * be much more for long sentences; the table grows as needed.
+ */
+static void init_table(count_context_t *ctxt, Sentence sent)
+{
+	size_t num_con = 0;
+
+	if (ctxt->table) free_table(ctxt);
+	ctxt->connector_base = sent->packed_connectors;
 
-	for (i=0; i<ctxt->table_size; i++)
+	for (size_t w = 0; w < sent->length; w++)
 	{
-		for(t = ctxt->table[i]; t!= NULL; t=x)
+		for (Disjunct *d = sent->word[w].d; d != NULL; d = d->next)
 		{
-			x = t->next;
-			xfree((void *) t, sizeof(Table_connector));
+			for (Connector *c = d->left; c != NULL; c = c->next) num_con++;
+			for (Connector *c = d->right; c != NULL; c = c->next) num_con++;
 		}
 	}
-	xfree(ctxt->table, ctxt->table_size * sizeof(Table_connector*));
-	ctxt->table = NULL;
-	ctxt->table_size = 0;
+
+	unsigned int size = next_power_of_two_up(4 * num_con);
+	if (size < MIN_TABLE_SIZE) size = MIN_TABLE_SIZE;
+
+	/* With a memory limit, the table may use up to half of it. It then
+	 * doesn't grow beyond that, and old counts get evicted instead. */
+	ctxt->max_table_memory = 0;
+	if ((NULL != ctxt->current_resources) &&
+	    (MAX_MEMORY_UNLIMITED != ctxt->current_resources->max_memory))
+	{
+		ctxt->max_table_memory = ctxt->current_resources->max_memory / 2;
+		while ((ZERO_SPAN_RATIO < size) &&
+		       (ctxt->max_table_memory < table_memory(size)))
+			size /= 2;
+	}
+
+	alloc_table_buckets(ctxt, size);
+
+	ctxt->zero_span_size = size / ZERO_SPAN_RATIO;
+	ctxt->zero_span = xalloc(ctxt->zero_span_size * sizeof(Zero_span));
+	memset(ctxt->zero_span, 0, ctxt->zero_span_size * sizeof(Zero_span));
+
+	ctxt->table_pool = pool_new(__func__, MAX_TABLE_LOAD(size),
+	                            sizeof(Table_connector));
 }
 
-static void init_table(count_context_t *ctxt, size_t sent_len)
+/**
+ * Reinsert the existing entries into a new bucket array of the given
+ * size. If evict is true, the entries that have not been used since
+ * the last rehash are put in the free list instead. The use marks of
+ * the kept entries are cleared. The entries themselves are not moved.
+ */
+static void rehash_table(count_context_t *ctxt, unsigned int size,
+                         bool evict)
 {
-	unsigned int shift;
-	/* A piecewise exponential function determines the size of the
-	 * hash table. Probably should make use of the actual number of
-	 * disjuncts, rather than just the number of words.
-	 */
-	if (ctxt->table) free_table(ctxt);
+	unsigned int old_size = ctxt->table_size;
+	Table_bucket *old_table = ctxt->table;
+
+	alloc_table_buckets(ctxt, size);
+
+	for (unsigned int i = 0; i < old_size; i++)
+	{
+		Table_connector *t = old_table[i].entry;
+		if (NULL == t) continue;
 
-	if (sent_len >= 10)
+		if (evict && !t->used)
+		{
+			FREE_NEXT(t) = ctxt->free_entries;
+			ctxt->free_entries = t;
+			continue;
+		}
+		t->used = false;
+
+		unsigned int h = pair_hash(ctxt->table_size, t->lw, t->rw,
+		                           t->le, t->re, t->null_count);
+		while (NULL != ctxt->table[h].entry)
+			h = (h + 1) & (ctxt->table_size - 1);
+		ctxt->table[h].entry = t;
+		ctxt->table[h].key = table_key(ctxt, t->lw, t->rw, t->le, t->re,
+		                               t->null_count);
+		ctxt->table_available--;
+	}
+
+	xfree(old_table, old_size * sizeof(Table_bucket));
+}
+
+/* Don't evict if less than 1/MIN_EVICT_FRACTION of the entries would
+ * be dropped, as the table would then be rehashed too often. */
+#define MIN_EVICT_FRACTION 8
+
+/**
+ * Make room in a full table that may not grow anymore, by dropping the
+ * entries that have not been looked up since the table was last
+ * rehashed. Return false, without dropping anything, if this would
+ * free too little of the table.
+ *
+ * Only such cold entries are dropped: the counts of the recursion in
+ * progress are looked up again and again (every pseudocount() is
+ * followed by a do_count() of the same key, and the sub-ranges are
+ * shared between the words and the null counts of a range), and
+ * dropping them would make the counting exponential.
+ *
+ * Dropping a count is otherwise safe, since it is just recomputed if
+ * needed again. Counts are stored only when they are complete, and
+ * nothing keeps pointers to table entries across a table_store().
+ */
+static bool evict_table_entries(count_context_t *ctxt)
+{
+	unsigned int num_entries = 0, num_cold = 0;
+
+	for (unsigned int i = 0; i < ctxt->table_size; i++)
 	{
-		shift = 12 + (sent_len) / 4 ;
+		Table_connector *t = ctxt->table[i].entry;
+		if (NULL == t) continue;
+		num_entries++;
+		if (!t->used) num_cold++;
 	}
-	else
+
+	if (MIN_EVICT_FRACTION * num_cold < num_entries)
 	{
-		shift = 12;
+		lgdebug(+D_COUNT, "Only %u of %u entries are cold; not evicting\n",
+		        num_cold, num_entries);
+		return false;
 	}
 
-	/* Clamp at max 4*(1<<24) == 64 MBytes */
-	if (24 < shift) shift = 24;
-	ctxt->table_size = (1U << shift);
-	ctxt->log2_table_size = shift;
-	ctxt->table = (Table_connector**)
-		xalloc(ctxt->table_size * sizeof(Table_connector*));
-	memset(ctxt->table, 0, ctxt->table_size*sizeof(Table_connector*));
+	lgdebug(+D_COUNT, "Evicting %u of %u entries\n", num_cold, num_entries);
+
+	rehash_table(ctxt, ctxt->table_size, true);
+	ctxt->evicted = true;
+	return true;
 }
 
+/**
+ * Make room for more entries: double the number of buckets, or, if
+ * this would exceed the memory limit, evict some entries. Return false
+ * if there is no room: the counts in use don't fit in the memory limit.
+ */
+static bool grow_table(count_context_t *ctxt)
+{
+	if ((0 != ctxt->max_table_memory) &&
+	    (ctxt->max_table_memory < table_memory(2 * ctxt->table_size)))
+	{
+		return evict_table_entries(ctxt);
+	}
+
+	rehash_table(ctxt, 2 * ctxt->table_size, false);
+	return true;
+}
+
+#ifdef USE_PTHREADS
+static Table_connector * table_store_parallel(count_context_t *,
+                                              int, int,
+                                              Connector *, Connector *,
+                                              unsigned int, Count_bin);
+#endif /* USE_PTHREADS */
+
 /**
  * Stores the value in the table.  Assumes it's not already there.
+ * Return NULL if the value could not be stored. This may happen in a
+ * helper thread, and when the table is at its memory limit; the memory
+ * is then considered exhausted, and the counting unwinds.
  */
 static Table_connector * table_store(count_context_t *ctxt,
                                      int lw, int rw,
                                      Connector *le, Connector *re,
-                                     unsigned int null_count)
+                                     unsigned int null_count,
+                                     Count_bin count)
 {
-	Table_connector *t, *n;
+	Table_connector *n;
 	unsigned int h;
 
-	n = (Table_connector *) xalloc(sizeof(Table_connector));
+#ifdef USE_PTHREADS
+	if (ctxt->parallel)
+		return table_store_parallel(ctxt, lw, rw, le, re, null_count, count);
+#endif /* USE_PTHREADS */
+
+	if ((0 >= ctxt->table_available) && !grow_table(ctxt))
+	{
+		lgdebug(+D_COUNT, "No room in %u buckets\n", ctxt->table_size);
+		ctxt->table_full = true;
+		ctxt->exhausted = true;
+		if (NULL != ctxt->current_resources)
+			resources_set_memory_exhausted(ctxt->current_resources);
+		return NULL;
+	}
+
+	if (NULL != ctxt->free_entries)
+	{
+		n = ctxt->free_entries;
+		ctxt->free_entries = FREE_NEXT(n);
+	}
+	else
+	{
+		n = (Table_connector *) pool_alloc(ctxt->table_pool);
+	}
 	n->lw = lw; n->rw = rw; n->le = le; n->re = re; n->null_count = null_count;
+	n->count = count;
+	n->used = true;
 	h = pair_hash(ctxt->table_size, lw, rw, le, re, null_count);
-	t = ctxt->table[h];
-	n->next = t;
-	ctxt->table[h] = n;
+	while (NULL != ctxt->table[h].entry)
+		h = (h + 1) & (ctxt->table_size - 1);
+	ctxt->table[h].entry = n;
+	ctxt->table[h].key = table_key(ctxt, lw, rw, le, re, null_count);
+	ctxt->table_available--;
 
 	return n;
 }
@@ -123,32 +417,280 @@ find_table_pointer(count_context_t *ctxt,
 {
 	Table_connector *t;
 	unsigned int h = pair_hash(ctxt->table_size,lw, rw, le, re, null_count);
-	t = ctxt->table[h];
-	for (; t != NULL; t = t->next) {
-		if ((t->lw == lw) && (t->rw == rw)
-		    && (t->le == le) && (t->re == re)
-		    && (t->null_count == null_count))  return t;
+	uint64_t key = table_key(ctxt, lw, rw, le, re, null_count);
+
+	for (; NULL != (t = table_bucket(ctxt, h)); h = (h + 1) & (ctxt->table_size - 1))
+	{
+		uint64_t bkey = table_bucket_key(ctxt, h);
+		if ((bkey != key) && (0 != bkey)) continue;
+		if (table_entry_is(t, lw, rw, le, re, null_count))
+		{
+			if (0 != ctxt->max_table_memory) t->used = true;
+			return t;
+		}
 	}
 
-	/* Create a new connector only if resources are exhausted.
-	 * (???) Huh? I guess we're in panic parse mode in that case.
+	/* Create a new connector only if resources are exhausted, or the
+	 * parse has been cancelled. A zero count is then stored for every
+	 * new entry, so the counting quickly unwinds.
 	 * checktimer is a device to avoid a gazillion system calls
-	 * to get the timer value. On circa-2009 machines, it results
-	 * in maybe 5-10 timer calls per second.
+	 * to get the timer value. The check is still frequent enough for
+	 * the parse to stop within a few milliseconds.
 	 */
 	ctxt->checktimer ++;
-	if (ctxt->exhausted || ((0 == ctxt->checktimer%1450100) &&
-	                       (ctxt->current_resources != NULL) &&
-	                       resources_exhausted(ctxt->current_resources)))
+	if (ctxt->exhausted ||
+	    ((0 == (ctxt->checktimer & (RESOURCES_CHECK_INTERVAL-1))) &&
+	     (ctxt->current_resources != NULL) &&
+	     resources_exhausted_or_cancelled(ctxt->current_resources,
+	                                      ctxt->current_sent)))
 	{
 		ctxt->exhausted = true;
-		t = table_store(ctxt, lw, rw, le, re, null_count);
-		t->count = hist_zero();
-		return t;
+		return table_store(ctxt, lw, rw, le, re, null_count, hist_zero());
 	}
 	else return NULL;
 }
 
+#ifdef USE_PTHREADS
+/* ============================================================= */
+/**
+ * Multi-threaded counting.
+ *
+ * The helper threads all count the same sentence as the main thread
+ * does, but visit the words of each range in a different order. They
+ * share the table with the main thread, so each of them mostly counts
+ * ranges that the others have not reached yet, and uses the counts
+ * that the others have already finished. Only the main thread result
+ * is used. A table entry is a pure function of its key, so it makes
+ * no difference which thread has stored it.
+ *
+ * Each helper has its own shallow copies of the disjuncts (they point
+ * to the same connectors) and its own fast matcher, because
+ * form_match_list() marks the disjuncts it puts in the match list.
+ * Each helper also allocates the table entries from its own pool.
+ *
+ * The table cannot grow while the helpers are running. When it gets
+ * full, a helper quits, and the main thread stops all of them, grows
+ * the table, and restarts them. They then quickly get back to where
+ * they were, using the counts in the table.
+ */
+
+/* Shorter sentences are counted faster than the helpers can start. */
+#define MIN_PARALLEL_SENTENCE_LENGTH 16
+
+struct count_helper_s
+{
+	pthread_t thread;
+	bool running;
+	count_context_t ctxt;     /* Shares the main thread table */
+	fast_matcher_t *mchxt;
+	Word *words;              /* Private copy of the sentence words */
+	Pool_desc *disjunct_pool; /* Private disjunct copies */
+	size_t length;
+	int null_count;
+};
+
+static void *count_helper(void *arg)
+{
+	count_helper_t *hp = arg;
+
+	do_count(hp->mchxt, &hp->ctxt, -1, hp->length, NULL, NULL,
+	         hp->null_count + 1);
+	return NULL;
+}
+
+static void start_helpers(count_context_t *ctxt)
+{
+	ctxt->stop = false;
+	ctxt->parallel = true;
+
+	for (int i = 0; i < ctxt->num_helpers; i++)
+	{
+		count_helper_t *hp = &ctxt->helper[i];
+
+		hp->ctxt.table = ctxt->table;
+		hp->ctxt.table_size = ctxt->table_size;
+		hp->ctxt.aborted = false;
+		hp->running =
+			(0 == pthread_create(&hp->thread, NULL, count_helper, hp));
+	}
+}
+
+static void stop_helpers(count_context_t *ctxt)
+{
+	__atomic_store_n(&ctxt->stop, true, __ATOMIC_RELEASE);
+
+	for (int i = 0; i < ctxt->num_helpers; i++)
+	{
+		count_helper_t *hp = &ctxt->helper[i];
+
+		if (!hp->running) continue;
+		pthread_join(hp->thread, NULL);
+		hp->running = false;
+	}
+	ctxt->parallel = false;
+}
+
+/**
+ * Give a helper its own copy of the sentence disjuncts, and a fast
+ * matcher for them. The copies share the connectors of the original
+ * disjuncts, and the connector addresses are what the table keys use.
+ */
+static void setup_helper(count_context_t *ctxt, count_helper_t *hp,
+                         Sentence sent, int null_count)
+{
+	struct Sentence_s hsent = *sent;
+
+	hp->length = sent->length;
+	hp->null_count = null_count;
+	hp->words = xalloc(sent->length * sizeof(Word));
+	memcpy(hp->words, sent->word, sent->length * sizeof(Word));
+	if (NULL == hp->disjunct_pool)
+		hp->disjunct_pool = pool_new("helper disjuncts", 1024, sizeof(Disjunct));
+
+	for (size_t w = 0; w < sent->length; w++)
+	{
+		Disjunct **dp = &hp->words[w].d;
+		for (Disjunct *d = sent->word[w].d; d != NULL; d = d->next)
+		{
+			*dp = pool_alloc(hp->disjunct_pool);
+			**dp = *d;
+			dp = &(*dp)->next;
+		}
+		*dp = NULL;
+	}
+
+	hsent.word = hp->words;
+	hp->mchxt = alloc_fast_matcher(&hsent);
+
+	hp->ctxt.local_sent = hp->words;
+	hp->ctxt.connector_base = ctxt->connector_base;
+	hp->ctxt.islands_ok = ctxt->islands_ok;
+	hp->ctxt.main_ctxt = ctxt;
+	hp->ctxt.parallel = true;
+	if (NULL == hp->ctxt.table_pool)
+	{
+		hp->ctxt.table_pool = pool_new("helper table", 16384,
+		                               sizeof(Table_connector));
+	}
+	if (NULL == hp->ctxt.zero_span)
+	{
+		hp->ctxt.zero_span_size = ctxt->zero_span_size;
+		hp->ctxt.zero_span =
+			xalloc(hp->ctxt.zero_span_size * sizeof(Zero_span));
+		memset(hp->ctxt.zero_span, 0,
+		       hp->ctxt.zero_span_size * sizeof(Zero_span));
+	}
+}
+
+static void release_helper(count_helper_t *hp)
+{
+	free_fast_matcher(hp->mchxt);
+	hp->mchxt = NULL;
+	xfree(hp->words, hp->length * sizeof(Word));
+	hp->words = NULL;
+	pool_reuse(hp->disjunct_pool);
+}
+
+/**
+ * Free the helpers. Their table entries are freed too, so this may be
+ * done only when the table is freed.
+ */
+static void free_helpers(count_context_t *ctxt)
+{
+	for (int i = 0; i < ctxt->num_helpers; i++)
+	{
+		count_context_t *hctxt = &ctxt->helper[i].ctxt;
+
+		pool_delete(hctxt->table_pool);
+		xfree(hctxt->zero_span, hctxt->zero_span_size * sizeof(Zero_span));
+		pool_delete(ctxt->helper[i].disjunct_pool);
+	}
+	xfree(ctxt->helper, ctxt->num_helpers * sizeof(count_helper_t));
+	ctxt->helper = NULL;
+	ctxt->num_helpers = 0;
+}
+
+static bool helper_should_quit(count_context_t *ctxt)
+{
+	return ctxt->aborted ||
+	       __atomic_load_n(&ctxt->main_ctxt->stop, __ATOMIC_ACQUIRE);
+}
+
+/**
+ * Store a table entry while the helpers are running. Insertion is
+ * lock-free: the entry is filled in, and then published by a
+ * compare-and-swap of an empty bucket. If another thread has already
+ * stored the same key, its entry is used instead.
+ */
+static Table_connector * table_store_parallel(count_context_t *ctxt,
+                                              int lw, int rw,
+                                              Connector *le, Connector *re,
+                                              unsigned int null_count,
+                                              Count_bin count)
+{
+	count_context_t *mctxt = (0 == ctxt->thread_id) ? ctxt : ctxt->main_ctxt;
+	Table_connector *n, *t;
+	unsigned int h;
+
+	/* A helper that was told to quit may have got bogus sub-counts. */
+	if ((0 != ctxt->thread_id) && helper_should_quit(ctxt)) return NULL;
+
+	if (0 >= __atomic_sub_fetch(&mctxt->table_available, 1, __ATOMIC_RELAXED))
+	{
+		if (0 != ctxt->thread_id)
+		{
+			ctxt->aborted = true;
+			return NULL;
+		}
+
+		/* The table is full, and only the main thread may grow it. */
+		stop_helpers(ctxt);
+		Table_connector *nt =
+			table_store(ctxt, lw, rw, le, re, null_count, count);
+		start_helpers(ctxt);
+		return nt;
+	}
+
+	n = (Table_connector *) pool_alloc(ctxt->table_pool);
+	n->lw = lw; n->rw = rw; n->le = le; n->re = re; n->null_count = null_count;
+	n->count = count;
+	n->used = true;
+	h = pair_hash(ctxt->table_size, lw, rw, le, re, null_count);
+	for (;;)
+	{
+		t = NULL;
+		if (__atomic_compare_exchange_n(&ctxt->table[h].entry, &t, n, false,
+		                                __ATOMIC_RELEASE, __ATOMIC_ACQUIRE))
+		{
+			/* Only the thread that has got the bucket stores its key. */
+			__atomic_store_n(&ctxt->table[h].key,
+			                 table_key(ctxt, lw, rw, le, re, null_count),
+			                 __ATOMIC_RELAXED);
+			return n;
+		}
+
+		/* The entry n is just left unused in the pool in that case. */
+		if (table_entry_is(t, lw, rw, le, re, null_count)) return t;
+
+		h = (h + 1) & (ctxt->table_size - 1);
+	}
+}
+
+/**
+ * The order in which the words of a range are visited. The main thread
+ * uses the natural order; the helpers reverse and/or rotate it.
+ */
+static inline int range_word(const count_context_t *ctxt,
+                             int start_word, int num_words, int i)
+{
+	if (0 == ctxt->thread_id) return start_word + i;
+	if (ctxt->thread_id & 1) i = num_words - 1 - i;
+	return start_word + (i + ctxt->thread_id/2) % num_words;
+}
+#else
+#define range_word(ctxt, start_word, num_words, i) ((start_word) + (i))
+#endif /* USE_PTHREADS */
+
 /** returns the count for this quintuple if there, -1 otherwise */
 Count_bin* table_lookup(count_context_t * ctxt,
                        int lw, int rw, Connector *le, Connector *re,
@@ -159,6 +701,34 @@ Count_bin* table_lookup(count_context_t * ctxt,
 	if (t == NULL) return NULL; else return &t->count;
 }
 
+/**
+ * Like table_lookup(), for use after the counting is done. If some
+ * counts have been evicted, a missing count may just have been
+ * dropped, so it is recomputed. If there is no room to recompute it,
+ * the parse set would be incomplete, so its building is aborted.
+ */
+Count_bin* table_lookup_count(Sentence sent, fast_matcher_t *mchxt,
+                              count_context_t * ctxt,
+                              int lw, int rw, Connector *le, Connector *re,
+                              unsigned int null_count)
+{
+	Count_bin *count = table_lookup(ctxt, lw, rw, le, re, null_count);
+
+	if ((NULL != count) || !ctxt->evicted) return count;
+
+	ctxt->local_sent = sent->word;
+	do_count(mchxt, ctxt, lw, rw, le, re, null_count);
+	ctxt->local_sent = NULL;
+
+	if (ctxt->table_full)
+	{
+		resources_set_memory_exhausted(sent->parse_info->resources);
+		sent->parse_info->aborted = true;
+		return NULL;
+	}
+	return table_lookup(ctxt, lw, rw, le, re, null_count);
+}
+
 /**
  * psuedocount is used to check to see if a parse is even possible,
  * so that we don't waste cpu time performing an actual count, only
@@ -181,6 +751,55 @@ static bool pseudocount(count_context_t * ctxt,
 	return true;
 }
 
+/**
+ * Known-zero spans.
+ *
+ * pseudocount() can tell that a sub-range cannot be parsed only if
+ * this exact range, with these exact connectors, has already been
+ * counted. But a coarser fact is often known: that the connector c
+ * cannot be linked to word w at all with the given null count in
+ * between, whatever the disjunct of w and the other end of the range
+ * are. This holds because the disjuncts of w that match c don't depend
+ * on the other end of the range (see form_match_list()).
+ *
+ * do_count() records such a fact when all the disjuncts of w that
+ * match c got a zero count on the side of c, and then skips w without
+ * even forming its match list when c and w meet again in another range.
+ * The cache is direct-mapped: a colliding fact just replaces the old
+ * one. Forgetting a fact is harmless, and the whole key is compared,
+ * so a fact is never wrongly assumed. Each helper thread has its own
+ * cache.
+ */
+static bool zero_span_known(const count_context_t *ctxt,
+                            const Connector *c, int w,
+                            unsigned int null_count)
+{
+	const Zero_span *zs;
+
+	if (NULL == ctxt->zero_span) return false;
+	zs = &ctxt->zero_span[pair_hash(ctxt->zero_span_size, w, 0, c, NULL,
+	                                null_count)];
+	return (zs->c == c) && (zs->w == w) && (zs->null_count == null_count);
+}
+
+static void zero_span_store(count_context_t *ctxt,
+                            Connector *c, int w,
+                            unsigned int null_count)
+{
+	Zero_span *zs;
+
+	if (NULL == ctxt->zero_span) return;
+#ifdef USE_PTHREADS
+	/* A helper that was told to quit may have got bogus zero counts. */
+	if ((0 != ctxt->thread_id) && helper_should_quit(ctxt)) return;
+#endif /* USE_PTHREADS */
+	zs = &ctxt->zero_span[pair_hash(ctxt->zero_span_size, w, 0, c, NULL,
+	                                null_count)];
+	zs->c = c;
+	zs->w = w;
+	zs->null_count = null_count;
+}
+
 /**
  * Return the number of optional words strictly between w1 and w2.
  */
@@ -207,13 +826,20 @@ static Count_bin do_count(fast_matcher_t *mchxt,
 
 	assert (0 <= null_count, "Bad null count");
 
+#ifdef USE_PTHREADS
+	if ((0 != ctxt->thread_id) && helper_should_quit(ctxt)) return zero;
+#endif /* USE_PTHREADS */
+
 	t = find_table_pointer(ctxt, lw, rw, le, re, null_count);
 
 	if (t) return t->count;
+	if (ctxt->table_full) return zero;
 
-	/* Create the table entry with a tentative null count of 0.
-	 * This count must be updated before we return. */
-	t = table_store(ctxt, lw, rw, le, re, null_count);
+	/* The count is stored in the table only when it is complete
+	 * (the ranges of the recursive calls are always shorter, so
+	 * this one is not looked up before that). */
+#define store_count(c) \
+	(table_store(ctxt, lw, rw, le, re, null_count, c), (c))
 
 	if (rw == 1+lw)
 	{
@@ -221,13 +847,12 @@ static Count_bin do_count(fast_matcher_t *mchxt,
 		/* You can't have a linkage here with null_count > 0 */
 		if ((le == NULL) && (re == NULL) && (null_count == 0))
 		{
-			t->count = hist_one();
+			return store_count(hist_one());
 		}
 		else
 		{
-			t->count = zero;
+			return store_count(zero);
 		}
-		return t->count;
 	}
 
 	/* The left and right connectors are null, but the two words are
@@ -241,38 +866,36 @@ static Count_bin do_count(fast_matcher_t *mchxt,
 			 * null_count of skipping n words is just n. */
 			if (null_count == (rw-lw-1) - num_optional_words(ctxt, lw, rw))
 			{
-				t->count = hist_one();
+				return store_count(hist_one());
 			}
 			else
 			{
-				t->count = zero;
+				return store_count(zero);
 			}
-			return t->count;
 		}
+		total = zero;
 		if (null_count == 0)
 		{
 			/* There is no solution without nulls in this case. There is
 			 * a slight efficiency hack to separate this null_count==0
 			 * case out, but not necessary for correctness */
-			t->count = zero;
 		}
 		else
 		{
-			t->count = zero;
 			Disjunct * d;
 			int w = lw + 1;
 			for (d = ctxt->local_sent[w].d; d != NULL; d = d->next)
 			{
 				if (d->left == NULL)
 				{
-					hist_accumv(&t->count, d->cost,
+					hist_accumv(&total, d->cost,
 						do_count(mchxt, ctxt, w, rw, d->right, NULL, null_count-1));
 				}
 			}
-			hist_accumv(&t->count, 0.0,
+			hist_accumv(&total, 0.0,
 				do_count(mchxt, ctxt, w, rw, NULL, NULL, null_count-1));
 		}
-		return t->count;
+		return store_count(total);
 	}
 
 	if (le == NULL)
@@ -295,9 +918,32 @@ static Count_bin do_count(fast_matcher_t *mchxt,
 
 	total = zero;
 
-	for (w = start_word; w < end_word; w++)
+	/* The connector on whose side a match must have a non-zero count:
+	 * le if there is one, else only a right match can be used. */
+	Connector *sc = (NULL != le) ? le : re;
+
+	for (int i = 0; i < end_word - start_word; i++)
 	{
 		size_t mlb, mle;
+		w = range_word(ctxt, start_word, end_word - start_word, i);
+
+		/* A side cannot have more null words than words. */
+		int lnull_min = MAX(0, null_count - (rw - w - 1));
+		int lnull_max = MIN(null_count, w - lw - 1);
+		if (lnull_min > lnull_max) continue;
+
+		/* The null counts (per lnull_cnt) for which the side of sc is
+		 * already known to be zero, or has been found to be non-zero. */
+		uint64_t known_zero = 0, nonzero = 0;
+		for (int n = lnull_min; n <= lnull_max; n++)
+		{
+			if (zero_span_known(ctxt, sc, w, (NULL != le) ? n : null_count - n))
+				known_zero |= ZERO_SPAN_BIT(n);
+		}
+		if ((lnull_max < 64) && (known_zero ==
+		     (ZERO_SPAN_BIT(lnull_max) << 1) - ZERO_SPAN_BIT(lnull_min)))
+			continue;
+
 		mle = mlb = form_match_list(mchxt, w, le, lw, re, rw);
 #ifdef VERIFY_MATCH_LIST
 		int id = get_match_list_element(mchxt, mlb) ?
@@ -314,14 +960,15 @@ static Count_bin do_count(fast_matcher_t *mchxt,
 			assert(id == d->match_id, "Modified id (%d!=%d)", id, d->match_id);
 #endif
 			/* _p1 avoids a gcc warning about unsafe loop opt */
-			unsigned int null_count_p1 = null_count + 1;
+			unsigned int lnull_max_p1 = lnull_max + 1;
 
-			for (lnull_cnt = 0; lnull_cnt < null_count_p1; lnull_cnt++)
+			for (lnull_cnt = lnull_min; lnull_cnt < lnull_max_p1; lnull_cnt++)
 			{
 				bool leftpcount = false;
 				bool rightpcount = false;
 				bool pseudototal = false;
 
+				if (known_zero & ZERO_SPAN_BIT(lnull_cnt)) continue;
 				rnull_cnt = null_count - lnull_cnt;
 				/* Now lnull_cnt and rnull_cnt are the costs we're assigning
 				 * to those parts respectively */
@@ -379,6 +1026,11 @@ static Count_bin do_count(fast_matcher_t *mchxt,
 				/* If pseudototal is zero (false), that implies that
 				 * we know that the true total is zero. So we don't
 				 * bother counting at all, in that case. */
+				if (!pseudototal && ((NULL != le) ? leftpcount : rightpcount))
+				{
+					/* The side of sc has not been counted. */
+					nonzero |= ZERO_SPAN_BIT(lnull_cnt);
+				}
 				if (pseudototal)
 				{
 					Count_bin leftcount = zero;
@@ -409,6 +1061,9 @@ static Count_bin do_count(fast_matcher_t *mchxt,
 								do_count(mchxt, ctxt, w, rw, d->right, re, rnull_cnt));
 					}
 
+					if (0 < hist_total((NULL != le) ? &leftcount : &rightcount))
+						nonzero |= ZERO_SPAN_BIT(lnull_cnt);
+
 					/* Total number where links are used on both sides */
 					hist_muladd(&total, &leftcount, 0.0, &rightcount);
 
@@ -433,17 +1088,23 @@ static Count_bin do_count(fast_matcher_t *mchxt,
 #else
 						total = INT_MAX;
 #endif /* PERFORM_COUNT_HISTOGRAMMING */
-						t->count = total;
 						pop_match_list(mchxt, mlb);
-						return total;
+						return store_count(total);
 					}
 				}
 			}
 		}
 		pop_match_list(mchxt, mlb);
+
+		for (int n = lnull_min; n <= lnull_max; n++)
+		{
+			uint64_t bit = ZERO_SPAN_BIT(n);
+			if ((0 != bit) && !((known_zero | nonzero) & bit))
+				zero_span_store(ctxt, sc, w, (NULL != le) ? n : null_count - n);
+		}
 	}
-	t->count = total;
-	return total;
+	return store_count(total);
+#undef store_count
 }
 
 
@@ -484,6 +1145,7 @@ Count_bin do_parse(Sentence sent,
 	Count_bin hist;
 
 	ctxt->current_resources = opts->resources;
+	ctxt->current_sent = sent;
 	ctxt->exhausted = false;
 	ctxt->checktimer = 0;
 	ctxt->local_sent = sent->word;
@@ -493,10 +1155,48 @@ Count_bin do_parse(Sentence sent,
 	/* ctxt->null_block = 1; */
 	ctxt->islands_ok = opts->islands_ok;
 
+	/* The table is kept across calls with different null counts. */
+	if (NULL == ctxt->table) init_table(ctxt, sent);
+
+#ifdef USE_PTHREADS
+	int num_helpers = opts->threads - 1;
+	if ((0 < num_helpers) && (MIN_PARALLEL_SENTENCE_LENGTH <= sent->length) &&
+	    (0 == ctxt->max_table_memory))
+	{
+		if (NULL == ctxt->helper)
+		{
+			ctxt->num_helpers = num_helpers;
+			ctxt->helper = xalloc(num_helpers * sizeof(count_helper_t));
+			memset(ctxt->helper, 0, num_helpers * sizeof(count_helper_t));
+			for (int i = 0; i < ctxt->num_helpers; i++)
+				ctxt->helper[i].ctxt.thread_id = i + 1;
+		}
+		for (int i = 0; i < ctxt->num_helpers; i++)
+			setup_helper(ctxt, &ctxt->helper[i], sent, null_count);
+		start_helpers(ctxt);
+	}
+#endif /* USE_PTHREADS */
+
 	hist = do_count(mchxt, ctxt, -1, sent->length, NULL, NULL, null_count+1);
 
+#ifdef USE_PTHREADS
+	if (ctxt->parallel)
+	{
+		stop_helpers(ctxt);
+		for (int i = 0; i < ctxt->num_helpers; i++)
+			release_helper(&ctxt->helper[i]);
+	}
+#endif /* USE_PTHREADS */
+
+	if (opts->verbosity >= D_USER_TIMES)
+	{
+		prt_error("++++ %-36s %zu bytes\n", "Count table memory",
+		          table_memory(ctxt->table_size));
+	}
+
 	ctxt->local_sent = NULL;
 	ctxt->current_resources = NULL;
+	ctxt->current_sent = NULL;
 	ctxt->checktimer = 0;
 	return hist;
 }
@@ -513,25 +1213,33 @@ void delete_unmarked_disjuncts(Sentence sent)
 			if (d->marked) {
 				d->next = d_head;
 				d_head = d;
-			} else {
-				d->next = NULL;
-				free_disjuncts(d);
 			}
 		}
 		sent->word[w].d = d_head;
 	}
 }
 
-/* sent_length is used only as a hint for the hash table size ... */
-count_context_t * alloc_count_context(size_t sent_length)
+/**
+ * The hash table is allocated on the first do_parse(), when the
+ * number of connectors left after pruning is known.
+ */
+count_context_t * alloc_count_context(void)
 {
 	count_context_t *ctxt = (count_context_t *) xalloc (sizeof(count_context_t));
 	memset(ctxt, 0, sizeof(count_context_t));
 
-	init_table(ctxt, sent_length);
 	return ctxt;
 }
 
+/**
+ * Drop all the counts. This is needed when the sentence disjuncts are
+ * replaced, since the table is keyed by connector addresses.
+ */
+void reset_count_context(count_context_t *ctxt)
+{
+	free_table(ctxt);
+}
+
 void free_count_context(count_context_t *ctxt)
 {
 	free_table(ctxt);
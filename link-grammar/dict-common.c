@@ -12,10 +12,13 @@
 /*************************************************************************/
 
 #include "anysplit.h"
+#include "build-disjuncts.h"
+#include "connector-enum.h"
 #include "dict-api.h"
 #include "dict-common.h"
 #include "externs.h"
 #include "pp_knowledge.h"
+#include "prune.h"
 #include "regex-morph.h"
 #include "spellcheck.h"
 #include "string-set.h"
@@ -361,6 +364,9 @@ void dictionary_delete(Dictionary dict)
 	}
 
 	connector_set_delete(dict->unlimited_connector_set);
+	disjunct_cache_delete(dict->disjunct_cache);
+	pp_prune_index_delete(dict->pp_prune_index);
+	connector_enum_delete(dict->connector_enum);
 
 	if (dict->close) dict->close(dict);
 
@@ -13,11 +13,14 @@
 
 #include "anysplit.h"
 #include "api-structures.h"
+#include "build-disjuncts.h"
+#include "connector-enum.h"
 #include "dict-api.h"
 #include "dict-common.h"
 #include "externs.h"
 #include "idiom.h"
 #include "pp_knowledge.h"
+#include "prune.h"
 #include "read-dict.h"
 #include "read-regex.h"
 #include "regex-morph.h"
@@ -604,6 +607,13 @@ dictionary_six_str(const char * lang,
 
 	free_lookup(dict_node);
 
+	dictionary_prune(dict);
+
+	/* The dictionary connectors are all known now. */
+	dict->connector_enum = connector_enum_create(dict->exp_list.exp_list);
+	dict->pp_prune_index = pp_prune_index_create(dict);
+	dict->disjunct_cache = disjunct_cache_create(dict);
+
 	return dict;
 
 failure:
@@ -1207,6 +1207,7 @@ void add_empty_word(Dictionary const dict, X_node *x)
 		an->u.l = elist;
 
 		x->exp = an;
+		x->dict_exp = NULL; /* Not a dictionary expression copy any more */
 	}
 }
 
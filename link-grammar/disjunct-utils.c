@@ -12,6 +12,8 @@
 
 #include <stdio.h>
 #include <string.h>
+#include "api-structures.h"
+#include "connector-enum.h"
 #include "disjunct-utils.h"
 #include "externs.h"
 #include "string-set.h"
@@ -139,7 +141,7 @@ static bool disjuncts_equal(Disjunct * d1, Disjunct * d2)
  * Duplicate the given connector chain.
  * If the argument is NULL, return NULL.
  */
-static Connector *connectors_dup(Connector *origc)
+static Connector *connectors_dup(Pool_desc *connector_pool, Connector *origc)
 {
 	Connector head;
 	Connector *prevc = &head;
@@ -148,7 +150,7 @@ static Connector *connectors_dup(Connector *origc)
 
 	for (t = origc; t != NULL;  t = t->next)
 	{
-		newc = connector_new();
+		newc = connector_new(connector_pool);
 		*newc = *t;
 
 		prevc->next = newc;
@@ -160,10 +162,10 @@ static Connector *connectors_dup(Connector *origc)
 }
 
 /**
- * Duplicate the given disjunct chain.
+ * Duplicate the given disjunct chain, in the sentence pools.
  * If the argument is NULL, return NULL.
  */
-Disjunct *disjuncts_dup(Disjunct *origd)
+Disjunct *disjuncts_dup(Sentence sent, Disjunct *origd)
 {
 	Disjunct head;
 	Disjunct *prevd = &head;
@@ -172,11 +174,11 @@ Disjunct *disjuncts_dup(Disjunct *origd)
 
 	for (t = origd; t != NULL; t = t->next)
 	{
-		newd = (Disjunct *)xalloc(sizeof(Disjunct));
+		newd = (Disjunct *) pool_alloc(sent->disjunct_pool);
 		newd->string = t->string;
 		newd->cost = t->cost;
-		newd->left = connectors_dup(t->left);
-		newd->right = connectors_dup(t->right);
+		newd->left = connectors_dup(sent->connector_pool, t->left);
+		newd->right = connectors_dup(sent->connector_pool, t->right);
 		newd->originating_gword = t->originating_gword;
 		prevd->next = newd;
 		prevd = newd;
@@ -186,6 +188,100 @@ Disjunct *disjuncts_dup(Disjunct *origd)
 	return head.next;
 }
 
+/**
+ * Copy the connector chain c to the array starting at *cp.
+ */
+static Connector *pack_connectors(Connector *c, Connector **cp)
+{
+	Connector head;
+	Connector *prevc = &head;
+
+	for (; c != NULL; c = c->next)
+	{
+		Connector *newc = (*cp)++;
+		*newc = *c;
+		prevc->next = newc;
+		prevc = newc;
+	}
+	prevc->next = NULL;
+
+	return head.next;
+}
+
+/**
+ * Pack the disjuncts and connectors that are left after pruning into
+ * contiguous arrays, replacing the word disjunct lists (which keep
+ * their order). The connectors of each disjunct are consecutive, the
+ * left ones first. Most of the pruned disjuncts are interleaved with
+ * the remaining ones in the sentence pools, so this keeps the counting
+ * and the linkage extraction in cache, and lets the connectors be
+ * identified by their index (see connector_index()).
+ * Previously packed arrays are freed. The disjuncts in the pools are
+ * not changed; the caller may release the pools if it doesn't keep a
+ * snapshot of them (see classic_parse()).
+ */
+void pack_sentence(Sentence sent)
+{
+	size_t num_dis = 0, num_con = 0;
+
+	free_packed_sentence(sent);
+
+	for (size_t w = 0; w < sent->length; w++)
+	{
+		for (Disjunct *d = sent->word[w].d; d != NULL; d = d->next)
+		{
+			num_dis++;
+			for (Connector *c = d->left; c != NULL; c = c->next) num_con++;
+			for (Connector *c = d->right; c != NULL; c = c->next) num_con++;
+		}
+	}
+	if (0 == num_dis) return;
+
+	sent->packed_disjuncts = xalloc(num_dis * sizeof(Disjunct));
+	sent->num_packed_disjuncts = num_dis;
+	if (0 != num_con)
+		sent->packed_connectors = xalloc(num_con * sizeof(Connector));
+	sent->num_packed_connectors = num_con;
+
+	Disjunct *dp = sent->packed_disjuncts;
+	Connector *cp = sent->packed_connectors;
+	for (size_t w = 0; w < sent->length; w++)
+	{
+		Disjunct head;
+		Disjunct *prevd = &head;
+
+		for (Disjunct *d = sent->word[w].d; d != NULL; d = d->next)
+		{
+			Disjunct *newd = dp++;
+			*newd = *d;
+			newd->left = pack_connectors(d->left, &cp);
+			newd->right = pack_connectors(d->right, &cp);
+			prevd->next = newd;
+			prevd = newd;
+		}
+		prevd->next = NULL;
+		sent->word[w].d = head.next;
+	}
+}
+
+void free_packed_sentence(Sentence sent)
+{
+	if (NULL != sent->packed_disjuncts)
+	{
+		xfree(sent->packed_disjuncts,
+		      sent->num_packed_disjuncts * sizeof(Disjunct));
+	}
+	if (NULL != sent->packed_connectors)
+	{
+		xfree(sent->packed_connectors,
+		      sent->num_packed_connectors * sizeof(Connector));
+	}
+	sent->packed_disjuncts = NULL;
+	sent->num_packed_disjuncts = 0;
+	sent->packed_connectors = NULL;
+	sent->num_packed_connectors = 0;
+}
+
 static disjunct_dup_table * disjunct_dup_table_new(size_t sz)
 {
 	size_t i;
@@ -284,19 +380,210 @@ static gword_set *gword_set_union(gword_set *kept, gword_set *eliminated)
 	return kept;
 }
 
+/**
+ * Return the size (in uint32_t units) of the key of the given disjunct.
+ */
+size_t disjunct_key_size(const Disjunct *d)
+{
+	size_t size = 1;
+
+	for (Connector *c = d->left; NULL != c; c = c->next) size++;
+	for (Connector *c = d->right; NULL != c; c = c->next) size++;
+	return size;
+}
+
+/**
+ * Encode the connectors of the given disjunct into key[], which must have
+ * at least disjunct_key_size(d) elements.
+ * The first element is the number of the left connectors in the upper
+ * 16 bits and the number of the right ones in the lower 16 bits. It is
+ * followed by (ID << 1 | multi) of each left and then right connector.
+ * Two disjuncts have the same connectors iff their keys are equal.
+ * Return false if a connector has no ID (see connector-enum.c) or there
+ * are too many connectors; the key is then invalid.
+ * The SAT parser doesn't need it: it encodes the word expressions
+ * directly, and never builds (nor removes duplicates from) the word
+ * disjunct lists.
+ */
+bool disjunct_key(const Disjunct *d, uint32_t *key)
+{
+	uint32_t *k = key + 1;
+	size_t num_left, num_right;
+
+	for (Connector *c = d->left; NULL != c; c = c->next)
+	{
+		if (0 == c->id) return false;
+		*k++ = ((uint32_t)c->id << 1) | c->multi;
+	}
+	num_left = k - key - 1;
+	for (Connector *c = d->right; NULL != c; c = c->next)
+	{
+		if (0 == c->id) return false;
+		*k++ = ((uint32_t)c->id << 1) | c->multi;
+	}
+	num_right = k - key - 1 - num_left;
+
+	if ((UINT16_MAX < num_left) || (UINT16_MAX < num_right)) return false;
+	key[0] = (uint32_t)(num_left << 16) | (uint32_t)num_right;
+	return true;
+}
+
+static void merge_duplicate_disjunct(Disjunct *kept, Disjunct *eliminated)
+{
+	if (eliminated->cost < kept->cost) kept->cost = eliminated->cost;
+
+	kept->originating_gword =
+		gword_set_union(kept->originating_gword, eliminated->originating_gword);
+}
+
+/**
+ * Rebuild the disjunct list from the duplicate table.
+ * The result is in the reverse order of the table buckets.
+ */
+static Disjunct *dup_table_disjuncts(disjunct_dup_table *dt)
+{
+	Disjunct *d = NULL;
+	Disjunct *dn, *dx;
+
+	for (size_t i = 0; i < dt->dup_table_size; i++)
+	{
+		for (dn = dt->dup_table[i]; dn != NULL; dn = dx) {
+			dx = dn->next;
+			dn->next = d;
+			d = dn;
+		}
+	}
+	return d;
+}
+
+/**
+ * Eliminate the duplicates using the disjunct keys, so a disjunct is
+ * compared by a memcmp() of its key instead of walking the connector
+ * lists. The table hash is the same as old_hash_disjunct(), which is
+ * computed here from the per-ID string hashes, so the resulting
+ * disjunct order is the same as that of the string comparison.
+ * Return false (leaving the list intact) if a connector has no ID.
+ */
+static bool eliminate_duplicates_by_key(disjunct_dup_table *dt,
+                                        const Connector_enum *ce,
+                                        Disjunct *d, unsigned int num_dis,
+                                        unsigned int *count)
+{
+	size_t key_size = 0;
+	for (Disjunct *t = d; t != NULL; t = t->next)
+		key_size += disjunct_key_size(t);
+
+	/* Per-disjunct key offset and full hash, and the key array. */
+	uint32_t *key_start = xalloc(num_dis * sizeof(*key_start));
+	uint32_t *key_hash = xalloc(num_dis * sizeof(*key_hash));
+	uint32_t *key = xalloc(key_size * sizeof(*key));
+	Disjunct **dis = xalloc(num_dis * sizeof(*dis));
+	unsigned int *next = xalloc(num_dis * sizeof(*next));
+	unsigned int *head = xalloc(dt->dup_table_size * sizeof(*head));
+	const unsigned int none = num_dis;
+	bool ok = true;
+
+	uint32_t *k = key;
+	const char *last_string = NULL;
+	unsigned int last_string_hash = 0;
+	unsigned int n = 0;
+	for (Disjunct *t = d; t != NULL; t = t->next, n++)
+	{
+		if (!disjunct_key(t, k))
+		{
+			ok = false;
+			goto done;
+		}
+		size_t len = 1 + (k[0] >> 16) + (k[0] & 0xFFFF);
+
+		if (t->string != last_string)
+		{
+			last_string = t->string;
+			last_string_hash = string_hash(t->string);
+		}
+		unsigned int h = last_string_hash;
+		for (size_t i = 1; i < len; i++)
+			h += ce->str_hash[k[i] >> 1];
+
+		dis[n] = t;
+		key_start[n] = k - key;
+		key_hash[n] = h;
+		k += len;
+	}
+
+	for (size_t i = 0; i < dt->dup_table_size; i++) head[i] = none;
+
+	for (n = 0; n < num_dis; n++)
+	{
+		unsigned int h = key_hash[n];
+		const uint32_t *kn = &key[key_start[n]];
+		size_t len = 1 + (kn[0] >> 16) + (kn[0] & 0xFFFF);
+		size_t b = (h + (h>>10)) & (dt->dup_table_size-1);
+		unsigned int x;
+
+		for (x = head[b]; x != none; x = next[x])
+		{
+			if (key_hash[x] != h) continue;
+			const uint32_t *kx = &key[key_start[x]];
+			if (0 != memcmp(kx, kn, len * sizeof(*kn))) continue;
+			if ((dis[x]->string == dis[n]->string) ||
+			    (0 == strcmp(dis[x]->string, dis[n]->string)))
+				break;
+		}
+		if (x == none)
+		{
+			next[n] = head[b];
+			head[b] = n;
+		}
+		else
+		{
+			merge_duplicate_disjunct(dis[x], dis[n]);
+			(*count)++;
+		}
+	}
+
+	for (size_t i = 0; i < dt->dup_table_size; i++)
+	{
+		Disjunct **tail = &dt->dup_table[i];
+		for (unsigned int x = head[i]; x != none; x = next[x])
+		{
+			*tail = dis[x];
+			tail = &dis[x]->next;
+		}
+		*tail = NULL;
+	}
+
+done:
+	xfree(key_start, num_dis * sizeof(*key_start));
+	xfree(key_hash, num_dis * sizeof(*key_hash));
+	xfree(key, key_size * sizeof(*key));
+	xfree(dis, num_dis * sizeof(*dis));
+	xfree(next, num_dis * sizeof(*next));
+	xfree(head, dt->dup_table_size * sizeof(*head));
+	return ok;
+}
+
 /**
  * Takes the list of disjuncts pointed to by d, eliminates all
  * duplicates, and returns a pointer to a new list.
- * It frees the disjuncts that are eliminated.
+ * The eliminated disjuncts are not freed; the sentence disjuncts are
+ * released with the sentence pools.
+ * If the connector IDs have been set (see set_connector_ids()), the
+ * disjuncts are compared by their keys. \p ce may be NULL.
  */
-Disjunct * eliminate_duplicate_disjuncts(Disjunct * d)
+Disjunct * eliminate_duplicate_disjuncts(Disjunct * d, const Connector_enum *ce)
 {
-	unsigned int i, h, count;
+	unsigned int h, count, num_dis;
 	Disjunct *dn, *dx;
 	disjunct_dup_table *dt;
 
 	count = 0;
-	dt = disjunct_dup_table_new(next_power_of_two_up(2 * count_disjuncts(d)));
+	num_dis = count_disjuncts(d);
+	dt = disjunct_dup_table_new(next_power_of_two_up(2 * num_dis));
+
+	if ((NULL != ce) && (0 != num_dis) &&
+	    eliminate_duplicates_by_key(dt, ce, d, num_dis, &count))
+		goto done;
 
 	while (d != NULL)
 	{
@@ -314,27 +601,14 @@ Disjunct * eliminate_duplicate_disjuncts(Disjunct * d)
 		}
 		else
 		{
-			d->next = NULL;  /* to prevent it from freeing the whole list */
-			if (d->cost < dx->cost) dx->cost = d->cost;
-
-			dx->originating_gword =
-				gword_set_union(dx->originating_gword, d->originating_gword);
-
-			free_disjuncts(d);
+			merge_duplicate_disjunct(dx, d);
 			count++;
 		}
 		d = dn;
 	}
 
-	/* d is already null */
-	for (i=0; i < dt->dup_table_size; i++)
-	{
-		for (dn = dt->dup_table[i]; dn != NULL; dn = dx) {
-			dx = dn->next;
-			dn->next = d;
-			d = dn;
-		}
-	}
+done:
+	d = dup_table_disjuncts(dt);
 
 	lgdebug(+5+(0==count)*1000, "Killed %u duplicates\n", count);
 
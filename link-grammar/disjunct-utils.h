@@ -13,6 +13,9 @@
 #ifndef _LINK_GRAMMAR_DISJUNCT_UTILS_H_
 #define _LINK_GRAMMAR_DISJUNCT_UTILS_H_
 
+#include <stdbool.h>
+#include <stdint.h>
+
 #include "api-types.h"
 #include "structures.h"
 
@@ -20,9 +23,28 @@
 void free_disjuncts(Disjunct *);
 unsigned int count_disjuncts(Disjunct *);
 Disjunct * catenate_disjuncts(Disjunct *, Disjunct *);
-Disjunct * eliminate_duplicate_disjuncts(Disjunct * );
+Disjunct * eliminate_duplicate_disjuncts(Disjunct *, const Connector_enum *);
 char * print_one_disjunct(Disjunct *);
 void word_record_in_disjunct(const Gword *, Disjunct *);
-Disjunct * disjuncts_dup(Disjunct *origd);
+Disjunct * disjuncts_dup(Sentence, Disjunct *origd);
+
+/* Packed sentence disjuncts ... */
+void pack_sentence(Sentence);
+void free_packed_sentence(Sentence);
+
+/**
+ * Return the index of connector c in the packed connector array whose
+ * start is base, counting from 1, or 0 if c is NULL.
+ */
+static inline uint32_t connector_index(const Connector *base,
+                                       const Connector *c)
+{
+	if (NULL == c) return 0;
+	return (uint32_t)(((uintptr_t)c - (uintptr_t)base) / sizeof(Connector)) + 1;
+}
+
+/* Disjunct keys, for comparing disjuncts by their connector IDs ... */
+size_t disjunct_key_size(const Disjunct *);
+bool disjunct_key(const Disjunct *, uint32_t *key);
 
 #endif /* _LINK_GRAMMAR_DISJUNCT_UTILS_H_ */
@@ -23,12 +23,17 @@
 
 /* ========================================================= */
 
-static Disjunct * build_expansion_disjuncts(Cluster *clu, X_node *x)
+static Disjunct * build_expansion_disjuncts(Sentence sent, Cluster *clu,
+                                            X_node *x)
 {
-	Disjunct *dj;
+	Disjunct *dj, *sdj;
 	dj = lg_cluster_get_disjuncts(clu, x->string);
 	if (dj && (verbosity > 0)) prt_error("Expanded %s \n", x->string);
-	return dj;
+
+	/* The sentence disjuncts are in the sentence pools. */
+	sdj = disjuncts_dup(sent, dj);
+	free_disjuncts(dj);
+	return sdj;
 }
 
 /**
@@ -49,12 +54,12 @@ bool lg_expand_disjunct_list(Sentence sent)
 		Disjunct * d = sent->word[w].d;
 		for (x = sent->word[w].x; x != NULL; x = x->next)
 		{
-			Disjunct *dx = build_expansion_disjuncts(clu, x);
+			Disjunct *dx = build_expansion_disjuncts(sent, clu, x);
 			if (dx)
 			{
 				unsigned int cnt = count_disjuncts(d);
 				d = catenate_disjuncts(dx, d);
-				d = eliminate_duplicate_disjuncts(d);
+				d = eliminate_duplicate_disjuncts(d, sent->dict->connector_enum);
 				if (cnt < count_disjuncts(d)) expanded = true;
 			}
 		}
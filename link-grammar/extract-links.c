@@ -17,6 +17,7 @@
 #include "extract-links.h"
 #include "fast-match.h"
 #include "linkage.h"
+#include "resources.h"
 #include "word-utils.h"
 
 /**
@@ -29,24 +30,13 @@
  * continuation).
  */
 
-static void free_set(Parse_set *s)
-{
-	Parse_choice *p, *xp;
-	if (s == NULL) return;
-	for (p=s->first; p != NULL; p = xp)
-	{
-		xp = p->next;
-		xfree((void *)p, sizeof(*p));
-	}
-}
-
 static Parse_choice *
 make_choice(Parse_set *lset, Connector * llc, Connector * lrc,
             Parse_set *rset, Connector * rlc, Connector * rrc,
-            Disjunct *ld, Disjunct *md, Disjunct *rd)
+            Disjunct *ld, Disjunct *md, Disjunct *rd, Parse_info pi)
 {
 	Parse_choice *pc;
-	pc = (Parse_choice *) xalloc(sizeof(*pc));
+	pc = (Parse_choice *) pool_alloc(pi->choice_pool);
 	pc->next = NULL;
 	pc->set[0] = lset;
 	pc->link[0].link_name = NULL;
@@ -87,11 +77,11 @@ static void put_choice_in_set(Parse_set *s, Parse_choice *pc)
 static void record_choice(
     Parse_set *lset, Connector * llc, Connector * lrc,
     Parse_set *rset, Connector * rlc, Connector * rrc,
-    Disjunct *ld, Disjunct *md, Disjunct *rd, Parse_set *s)
+    Disjunct *ld, Disjunct *md, Disjunct *rd, Parse_set *s, Parse_info pi)
 {
 	put_choice_in_set(s, make_choice(lset, llc, lrc,
 	                                 rset, rlc, rrc,
-	                                 ld, md, rd));
+	                                 ld, md, rd, pi));
 }
 
 /**
@@ -125,35 +115,33 @@ Parse_info parse_info_new(int nwords)
 	pi->x_table = (X_table_connector**) xalloc(pi->x_table_size * sizeof(X_table_connector*));
 	memset(pi->x_table, 0, pi->x_table_size * sizeof(X_table_connector*));
 
+	pi->x_table_pool = pool_new("X_table_connector", 1024,
+	                            sizeof(X_table_connector));
+	pi->choice_pool = pool_new(__func__, 1024, sizeof(Parse_choice));
+
 	return pi;
 }
 
+static void free_kbest_nodes(Parse_info);
+
 /**
  * This is the function that should be used to free the set structure. Since
  * it's a dag, a recursive free function won't work.  Every time we create
- * a set element, we put it in the hash table, so this is OK.
+ * a set element, we allocate it in the x_table pool, so this is OK.
  */
 void free_parse_info(Parse_info pi)
 {
-	unsigned int i;
-	X_table_connector *t, *x;
 	if (!pi) return;
 
-	for (i=0; i<pi->x_table_size; i++)
-	{
-		for (t = pi->x_table[i]; t!= NULL; t=x)
-		{
-			x = t->next;
-			free_set(&t->set);
-			xfree((void *) t, sizeof(X_table_connector));
-		}
-	}
 	pi->parse_set = NULL;
 
 	/*printf("Freeing x_table of size %d\n", x_table_size);*/
 	xfree((void *) pi->x_table, pi->x_table_size * sizeof(X_table_connector*));
 	pi->x_table_size = 0;
 	pi->x_table = NULL;
+	pool_delete(pi->x_table_pool);
+	pool_delete(pi->choice_pool);
+	free_kbest_nodes(pi);
 
 	xfree((void *) pi, sizeof(struct Parse_info_struct));
 }
@@ -185,7 +173,7 @@ static X_table_connector * x_table_store(int lw, int rw,
 	X_table_connector *t, *n;
 	unsigned int h;
 
-	n = (X_table_connector *) xalloc(sizeof(X_table_connector));
+	n = (X_table_connector *) pool_alloc(pi->x_table_pool);
 	n->set.lw = lw;
 	n->set.rw = rw;
 	n->set.null_count = null_count;
@@ -194,6 +182,7 @@ static X_table_connector * x_table_store(int lw, int rw,
 	n->set.count = 0;
 	n->set.first = NULL;
 	n->set.tail = NULL;
+	n->set.kbest = NULL;
 
 	h = pair_hash(pi->x_table_size, lw, rw, le, re, null_count);
 	t = pi->x_table[h];
@@ -279,7 +268,17 @@ Parse_set * mk_parse_set(Sentence sent, fast_matcher_t *mchxt,
 
 	assert(null_count < 0x7fff, "mk_parse_set() called with null_count < 0.");
 
-	count = table_lookup(ctxt, lw, rw, le, re, null_count);
+	/* The resulting parse set is incomplete if the parse is abandoned,
+	 * so it is then discarded by build_parse_set(). */
+	if (pi->aborted) return NULL;
+	if ((0 == (++pi->checktimer & (RESOURCES_CHECK_INTERVAL-1))) &&
+	    resources_exhausted_or_cancelled(pi->resources, sent))
+	{
+		pi->aborted = true;
+		return NULL;
+	}
+
+	count = table_lookup_count(sent, mchxt, ctxt, lw, rw, le, re, null_count);
 
 	/* If there's no counter, then there's no way to parse. */
 	if (NULL == count) return NULL;
@@ -332,7 +331,7 @@ Parse_set * mk_parse_set(Sentence sent, fast_matcher_t *mchxt,
 				dummy = dummy_set(lw, w, null_count-1, pi);
 				record_choice(dummy, NULL, NULL,
 				              pset,  NULL, NULL,
-				              NULL, NULL, NULL, &xt->set);
+				              NULL, dis, NULL, &xt->set, pi);
 				RECOUNT({xt->set.recount += pset->recount;})
 			}
 		}
@@ -344,7 +343,7 @@ Parse_set * mk_parse_set(Sentence sent, fast_matcher_t *mchxt,
 			dummy = dummy_set(lw, w, null_count-1, pi);
 			record_choice(dummy, NULL, NULL,
 			              pset,  NULL, NULL,
-			              NULL, NULL, NULL, &xt->set);
+			              NULL, NULL, NULL, &xt->set, pi);
 			RECOUNT({xt->set.recount += pset->recount;})
 		}
 		return &xt->set;
@@ -454,7 +453,7 @@ Parse_set * mk_parse_set(Sentence sent, fast_matcher_t *mchxt,
 						if (rs[j] == NULL) continue;
 						record_choice(ls[i], le, d->left,
 						              rs[j], d->right, re,
-						              ld, d, rd, &xt->set);
+						              ld, d, rd, &xt->set, pi);
 						RECOUNT({xt->set.recount += ls[i]->recount * rs[j]->recount;})
 					}
 				}
@@ -475,7 +474,7 @@ Parse_set * mk_parse_set(Sentence sent, fast_matcher_t *mchxt,
 							record_choice(ls[i], le, d->left,
 							              rset,  NULL /* d->right */,
 							              re,  /* the NULL indicates no link*/
-							              ld, d, rd, &xt->set);
+							              ld, d, rd, &xt->set, pi);
 							RECOUNT({xt->set.recount += ls[i]->recount * rset->recount;})
 						}
 					}
@@ -498,7 +497,7 @@ Parse_set * mk_parse_set(Sentence sent, fast_matcher_t *mchxt,
 							record_choice(lset, NULL /* le */,
 							                    d->left,  /* NULL indicates no link */
 							              rs[j], d->right, re,
-							              ld, d, rd, &xt->set);
+							              ld, d, rd, &xt->set, pi);
 							RECOUNT({xt->set.recount += lset->recount * rs[j]->recount;})
 						}
 					}
@@ -563,11 +562,22 @@ bool build_parse_set(Sentence sent, fast_matcher_t *mchxt,
                     count_context_t *ctxt,
                     unsigned int null_count, Parse_Options opts)
 {
+	sent->parse_info->resources = opts->resources;
+	sent->parse_info->checktimer = 0;
+	sent->parse_info->aborted = false;
+
 	sent->parse_info->parse_set =
 		mk_parse_set(sent, mchxt, ctxt,
 		             NULL, NULL, -1, sent->length, NULL, NULL, null_count+1,
 		             opts->islands_ok, sent->parse_info);
 
+	if (sent->parse_info->aborted)
+	{
+		/* No linkages can be extracted from an incomplete parse set. */
+		sent->parse_info->parse_set = NULL;
+		sent->num_linkages_found = 0;
+		return false;
+	}
 
 	return set_overflowed(sent->parse_info);
 }
@@ -644,6 +654,242 @@ static void list_random_links(Linkage lkg, Parse_info pi, const Parse_set * set)
 	list_random_links(lkg, pi, pc->set[1]);
 }
 
+/**
+ * k-best extraction: Enumerate the parses in order of increasing cost.
+ *
+ * Each parse set keeps the parses (derivations) of its range that have
+ * been found so far, lowest-cost first, plus a heap of candidates for
+ * the next one. A derivation is a choice together with the rank of the
+ * parses used in its two sub-sets. The next-best derivation of a set
+ * is always either one of its choices with the best parses of both
+ * sub-sets, or a neighbour of an already-found derivation, in which
+ * one sub-set parse is replaced by the next-ranked one. So the
+ * sub-sets are only asked for as many parses as actually needed.
+ * This is the "lazy" k-best algorithm of Huang and Chiang (2005).
+ *
+ * The cost is the one used for sorting the linkages: the disjunct
+ * cost, and then the link cost (see linkage_score()).
+ */
+typedef struct
+{
+	Parse_choice *pc;     /* NULL for a set that has no choices */
+	unsigned int rank[2]; /* Parse ranks in pc->set[0] and pc->set[1] */
+	double dcost;         /* Disjunct cost */
+	int lcost;            /* Link cost */
+} Derivation;
+
+struct Kbest_node_struct
+{
+	Kbest_node *next;     /* For freeing */
+	Derivation *best;     /* Parses found so far; lowest cost first */
+	Derivation *cand;     /* Candidate heap */
+	unsigned int nbest, best_size;
+	unsigned int ncand, cand_size;
+	unsigned int nexpanded; /* Parses whose neighbours are in the heap */
+};
+
+static void free_kbest_nodes(Parse_info pi)
+{
+	Kbest_node *kn, *next;
+
+	for (kn = pi->kbest_nodes; NULL != kn; kn = next)
+	{
+		next = kn->next;
+		free(kn->best);
+		free(kn->cand);
+		xfree(kn, sizeof(Kbest_node));
+	}
+	pi->kbest_nodes = NULL;
+}
+
+static bool derivation_less(const Derivation *a, const Derivation *b)
+{
+	if (a->dcost != b->dcost) return a->dcost < b->dcost;
+	return a->lcost < b->lcost;
+}
+
+static void cand_push(Kbest_node *kn, const Derivation *dv)
+{
+	unsigned int i;
+
+	if (kn->ncand == kn->cand_size)
+	{
+		kn->cand_size = 2 * kn->cand_size + 8;
+		kn->cand = realloc(kn->cand, kn->cand_size * sizeof(Derivation));
+	}
+
+	for (i = kn->ncand++; 0 < i; i = (i-1)/2)
+	{
+		if (!derivation_less(dv, &kn->cand[(i-1)/2])) break;
+		kn->cand[i] = kn->cand[(i-1)/2];
+	}
+	kn->cand[i] = *dv;
+}
+
+static void cand_pop(Kbest_node *kn, Derivation *dv)
+{
+	Derivation last = kn->cand[--kn->ncand];
+	unsigned int i = 0;
+
+	*dv = kn->cand[0];
+	for (;;)
+	{
+		unsigned int c = 2*i + 1;
+		if (c >= kn->ncand) break;
+		if ((c+1 < kn->ncand) && derivation_less(&kn->cand[c+1], &kn->cand[c]))
+			c++;
+		if (!derivation_less(&kn->cand[c], &last)) break;
+		kn->cand[i] = kn->cand[c];
+		i = c;
+	}
+	kn->cand[i] = last;
+}
+
+static const Derivation *kbest_get(Parse_set *, unsigned int, Parse_info);
+
+/**
+ * Make the derivation of pc with the given sub-set parses.
+ * Return false if one of these parses doesn't exist.
+ */
+static bool make_derivation(Derivation *dv, Parse_choice *pc,
+                            unsigned int r0, unsigned int r1, Parse_info pi)
+{
+	const Derivation *sub;
+
+	dv->pc = pc;
+	dv->rank[0] = r0;
+	dv->rank[1] = r1;
+	dv->dcost = (NULL == pc->md) ? 0.0 : pc->md->cost;
+	dv->lcost = 0;
+	for (int i = 0; i < 2; i++)
+	{
+		if (NULL != pc->link[i].lc)
+			dv->lcost += pc->link[i].rw - pc->link[i].lw - 1;
+	}
+
+	sub = kbest_get(pc->set[0], r0, pi);
+	if (NULL == sub) return false;
+	dv->dcost += sub->dcost;
+	dv->lcost += sub->lcost;
+
+	sub = kbest_get(pc->set[1], r1, pi);
+	if (NULL == sub) return false;
+	dv->dcost += sub->dcost;
+	dv->lcost += sub->lcost;
+
+	return true;
+}
+
+static Kbest_node *kbest_node(Parse_set *set, Parse_info pi)
+{
+	Kbest_node *kn = set->kbest;
+	Derivation dv;
+
+	if (NULL != kn) return kn;
+
+	kn = (Kbest_node *) xalloc(sizeof(Kbest_node));
+	memset(kn, 0, sizeof(Kbest_node));
+	kn->next = pi->kbest_nodes;
+	pi->kbest_nodes = kn;
+
+	if (NULL == set->first)
+	{
+		/* Adjacent words, or skipped ones: a single empty parse. */
+		kn->best = malloc(sizeof(Derivation));
+		kn->best_size = kn->nbest = kn->nexpanded = 1;
+		memset(kn->best, 0, sizeof(Derivation));
+	}
+	else
+	{
+		for (Parse_choice *pc = set->first; pc != NULL; pc = pc->next)
+		{
+			if (make_derivation(&dv, pc, 0, 0, pi)) cand_push(kn, &dv);
+		}
+	}
+
+	set->kbest = kn;
+	return kn;
+}
+
+/**
+ * Return the k'th lowest-cost parse of the given set (k=0 is the
+ * best one), or NULL if it has less than k+1 parses. The returned
+ * pointer is valid only until the next call for this set.
+ */
+static const Derivation *kbest_get(Parse_set *set, unsigned int k,
+                                   Parse_info pi)
+{
+	Kbest_node *kn = kbest_node(set, pi);
+	Derivation dv;
+
+	while (kn->nbest <= k)
+	{
+		if (kn->nexpanded < kn->nbest)
+		{
+			/* Add the neighbours of the last found parse. Advancing the
+			 * left rank only from right rank 0 reaches each pair of ranks
+			 * through exactly one path, so no duplicates are added. */
+			Derivation last = kn->best[kn->nbest-1];
+			Parse_choice *pc = last.pc;
+			unsigned int r0 = last.rank[0], r1 = last.rank[1];
+
+			kn->nexpanded = kn->nbest;
+			if ((0 == r1) && make_derivation(&dv, pc, r0+1, r1, pi))
+				cand_push(kn, &dv);
+			if (make_derivation(&dv, pc, r0, r1+1, pi))
+				cand_push(kn, &dv);
+		}
+		if (0 == kn->ncand) return NULL;
+
+		if (kn->nbest == kn->best_size)
+		{
+			kn->best_size = 2 * kn->best_size + 4;
+			kn->best = realloc(kn->best, kn->best_size * sizeof(Derivation));
+		}
+		cand_pop(kn, &kn->best[kn->nbest++]);
+	}
+
+	return &kn->best[k];
+}
+
+static void list_kbest_links(Linkage lkg, Parse_set *set, unsigned int k,
+                             Parse_info pi)
+{
+	const Derivation *dv = kbest_get(set, k, pi);
+	Parse_choice *pc = dv->pc;
+
+	if (NULL == pc) return;
+	unsigned int r0 = dv->rank[0], r1 = dv->rank[1];
+
+	issue_links_for_choice(lkg, pc);
+	list_kbest_links(lkg, pc->set[0], r0, pi);
+	list_kbest_links(lkg, pc->set[1], r1, pi);
+}
+
+/**
+ * Generate the links of the index'th lowest-cost parsing of the
+ * sentence. Unlike extract_links(), this is usable even if the
+ * parse count has overflowed. Return false if there is no such
+ * parsing.
+ */
+bool extract_kbest_links(Linkage lkg, Parse_info pi)
+{
+	if (NULL == kbest_get(pi->parse_set, lkg->lifo.index, pi)) return false;
+	list_kbest_links(lkg, pi->parse_set, lkg->lifo.index, pi);
+	return true;
+}
+
+/**
+ * Return the disjunct cost of the index'th lowest-cost parsing of the
+ * sentence, or a huge cost if there is no such parsing. No parsing
+ * after it has a lower disjunct cost.
+ */
+double kbest_disjunct_cost(Parse_info pi, int index)
+{
+	const Derivation *dv = kbest_get(pi->parse_set, index, pi);
+	return (NULL == dv) ? 1.0e38 : dv->dcost;
+}
+
 /**
  * Generate the list of all links of the index'th parsing of the
  * sentence.  For this to work, you must have already called parse, and
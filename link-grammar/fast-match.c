@@ -12,6 +12,7 @@
 /**************************************************************************/
 
 #include "api-structures.h"
+#include "connector-enum.h"
 #include "externs.h"
 #include "fast-match.h"
 #include "string-set.h"
@@ -36,10 +37,16 @@
  * for long and/or complex sentences.
  * pop_match_list() releases the memory that form_match_list() returned
  * by unwinding this stack.
+ *
+ * The lists of the disjuncts that match a given connector at a given
+ * word are computed only once per matcher, and kept in a cache. The
+ * match-list that form_match_list() pushes is then merged from the
+ * cached lists of its two connectors.
  */
 
 #define MATCH_LIST_SIZE_INIT 4096 /* the initial size of the match-list stack */
 #define MATCH_LIST_SIZE_INC 2     /* match-list stack increase size factor */
+#define ML_CACHE_SIZE_INIT 1024   /* the initial one-sided match-list cache size */
 
 /**
  * Returns the number of disjuncts in the list that have non-null
@@ -78,121 +85,38 @@ static void push_match_list_element(fast_matcher_t *ctxt, Disjunct *d)
 	ctxt->match_list[ctxt->match_list_end++] = d;
 }
 
-static void free_match_list(Match_node * t)
-{
-	Match_node *xt;
-	for (; t!=NULL; t=xt) {
-		xt = t->next;
-		xfree((char *)t, sizeof(Match_node));
-	}
-}
-
 /**
- * Free all of the hash tables and Match_nodes
+ * Free the bin tables and the bin arrays.
  */
 void free_fast_matcher(fast_matcher_t *mchxt)
 {
-	size_t w;
-	unsigned int i;
-
 	if (NULL == mchxt) return;
-	for (w = 0; w < mchxt->size; w++)
-	{
-		for (i = 0; i < mchxt->l_table_size[w]; i++)
-		{
-			free_match_list(mchxt->l_table[w][i]);
-		}
-		xfree((char *)mchxt->l_table[w], mchxt->l_table_size[w] * sizeof (Match_node *));
-		for (i = 0; i < mchxt->r_table_size[w]; i++)
-		{
-			free_match_list(mchxt->r_table[w][i]);
-		}
-		xfree((char *)mchxt->r_table[w], mchxt->r_table_size[w] * sizeof (Match_node *));
-	}
 
-	free(mchxt->match_list);
-	lgdebug(6, "Sentence size %zu, match_list_size %zu\n",
-	        mchxt->size, mchxt->match_list_size);
+	xfree(mchxt->bin_table, mchxt->bin_table_size * sizeof(Match_bin));
+	xfree(mchxt->bin_store, mchxt->bin_store_size * sizeof(Disjunct *));
 
-	xfree(mchxt->l_table_size, mchxt->size * sizeof(unsigned int));
-	xfree(mchxt->l_table, mchxt->size * sizeof(Match_node **));
+	free(mchxt->match_list);
+	free(mchxt->ml_store);
+	xfree(mchxt->ml_cache, mchxt->ml_cache_size * sizeof(ml_cache_entry));
+	lgdebug(6, "Sentence size %zu, match_list_size %zu, "
+	        "%zu cached match lists in %zu elements\n",
+	        mchxt->size, mchxt->match_list_size,
+	        mchxt->ml_cache_count, mchxt->ml_store_end);
+
+	xfree(mchxt->l_table_size, 2 * mchxt->size * sizeof(unsigned int));
+	xfree(mchxt->l_table, 2 * mchxt->size * sizeof(Match_bin *));
 	xfree(mchxt, sizeof(fast_matcher_t));
 }
 
-/**
- * Adds the match node m to the sorted list of match nodes l.
- * The parameter dir determines the order of the sorting to be used.
- * Makes the list sorted from smallest to largest.
- */
-static Match_node * add_to_right_table_list(Match_node * m, Match_node * l)
-{
-	Match_node *p, *prev;
-
-	if (l == NULL) return m;
-
-	/* Insert m at head of list */
-	if ((m->d->right->nearest_word) <= (l->d->right->nearest_word))
-	{
-		m->next = l;
-		return m;
-	}
-
-	/* Walk list to insertion point */
-	prev = l;
-	p = prev->next;
-	while (p != NULL && ((m->d->right->nearest_word) > (p->d->right->nearest_word)))
-	{
-		prev = p;
-		p = p->next;
-	}
-
-	m->next = p;
-	prev->next = m;
-
-	return l;  /* return pointer to original head */
-}
-
-/**
- * Adds the match node m to the sorted list of match nodes l.
- * The parameter dir determines the order of the sorting to be used.
- * Makes the list sorted from largest to smallest
- */
-static Match_node * add_to_left_table_list(Match_node * m, Match_node * l)
-{
-	Match_node *p, *prev;
-
-	if (l == NULL) return m;
-
-	/* Insert m at head of list */
-	if ((m->d->left->nearest_word) >= (l->d->left->nearest_word))
-	{
-		m->next = l;
-		return m;
-	}
-
-	/* Walk list to insertion point */
-	prev = l;
-	p = prev->next;
-	while (p != NULL && ((m->d->left->nearest_word) < (p->d->left->nearest_word)))
-	{
-		prev = p;
-		p = p->next;
-	}
-
-	m->next = p;
-	prev->next = m;
-
-	return l;  /* return pointer to original head */
-}
-
 /**
  * Compare only the uppercase part of two connectors.
  * Return true if they are the same, else false.
- * FIXME: Use connector enumeration.
  */
-static bool con_uc_eq(const Connector *c1, const Connector *c2)
+static bool con_uc_eq(const Connector_enum *ce,
+                      const Connector *c1, const Connector *c2)
 {
 	if (string_set_cmp(c1->string, c2->string)) return true;
+	if ((0 != c1->id) && (0 != c2->id)) return connector_enum_uc_eq(ce, c1, c2);
 	if (c1->hash != c2->hash) return false;
 	if (c1->uc_length != c2->uc_length) return false;
 
@@ -203,127 +127,183 @@ static bool con_uc_eq(const Connector *c1, const Connector *c2)
 	 * we are hashing, at most, a few dozen connectors into a
 	 * 16-bit hash space (65536 slots).
 	 */
-	const char *uc1 = &c1->string[c1->uc_start];
-	const char *uc2 = &c2->string[c2->uc_start];
+	const char *uc1 = &c1->string[connector_uc_start(c1)];
+	const char *uc2 = &c2->string[connector_uc_start(c2)];
 	if (0 == strncmp(uc1, uc2, c1->uc_length)) return true;
 
 	return false;
 }
 
-static Match_node **get_match_table_entry(unsigned int size, Match_node **t,
-                                          Connector * c, int dir)
+/**
+ * Return the bin of the upper-case part of c in the bin table t, or an
+ * unused bin (whose count is 0) if there is none.
+ * Return NULL if the table is full and c is not in it.
+ */
+static Match_bin *get_match_table_entry(const Connector_enum *ce,
+                                        unsigned int size, Match_bin *t,
+                                        Connector * c)
 {
 	unsigned int h, s;
 
 	s = h = connector_hash(c) & (size-1);
 
-	if (dir == 1) {
-		while (NULL != t[h])
-		{
-			if (con_uc_eq(t[h]->d->right, c)) break;
-
-			/* Increment and try again. Every hash bucket MUST have
-			 * a unique upper-case part, since later on, we only
-			 * compare the lower-case parts, assuming upper-case
-			 * parts are already equal. So just look for the next
-			 * unused hash bucket.
-			 */
-			h = (h + 1) & (size-1);
-			if (NULL == t[h]) break;
-			if (h == s) return NULL;
-		}
-	}
-	else
+	while (0 != t[h].count)
 	{
-		while (NULL != t[h])
-		{
-			if (con_uc_eq(t[h]->d->left, c)) break;
-			h = (h + 1) & (size-1);
-			if (NULL == t[h]) break;
-			if (h == s) return NULL;
-		}
+		if (con_uc_eq(ce, t[h].c, c)) break;
+
+		/* Increment and try again. Every bin MUST have a unique
+		 * upper-case part, since later on, we only compare the
+		 * lower-case parts, assuming upper-case parts are already
+		 * equal. So just look for the next unused bin.
+		 */
+		h = (h + 1) & (size-1);
+		if (h == s) return NULL;
 	}
 
 	return &t[h];
 }
 
 /**
- * The disjunct d (whose left or right pointer points to c) is put
- * into the appropriate hash table
- * dir =  1, we're putting this into a right table.
- * dir = -1, we're putting this into a left table.
+ * Build the bin table t of word w. dir = 1 for its right connectors,
+ * and -1 for its left ones. The disjuncts of each bin are put
+ * contiguously in ctxt->bin_store, starting at *store_end.
+ *
+ * The disjuncts of each bin are sorted by the nearest_word of their
+ * connector, the nearest to w first, so form_match_list() can stop
+ * at the first one that is too far. Disjuncts with the same
+ * nearest_word are in reverse order of the word's disjunct list.
  */
-static void put_into_match_table(unsigned int size, Match_node ** t,
-                                 Disjunct * d, Connector * c, int dir )
+static void build_match_table(fast_matcher_t *ctxt, Disjunct *dlist,
+                              unsigned int size, Match_bin *t,
+                              int dir, size_t *store_end, Disjunct **tmp)
 {
-	Match_node *m, **xl;
+	size_t n = 0;
+	Disjunct *d;
 
-	m = (Match_node *) xalloc (sizeof(Match_node));
-	m->next = NULL;
-	m->d = d;
+	/* Count the disjuncts of each bin. */
+	for (d = dlist; d != NULL; d = d->next)
+	{
+		Connector *c = (dir < 0) ? d->left : d->right;
+		if (NULL == c) continue;
+
+		Match_bin *b = get_match_table_entry(ctxt->cenum, size, t, c);
+		assert(NULL != b, "get_match_table_entry: Overflow");
+		if (0 == b->count) b->c = c;
+		b->count++;
+		n++;
+	}
+	if (0 == n) return;
 
-	xl = get_match_table_entry(size, t, c, dir);
-	assert(NULL != xl, "get_match_table_entry: Overflow");
-	if (dir == 1) {
-		*xl = add_to_right_table_list(m, *xl);
+	/* Set the start of each bin to its end; it is moved back to the
+	 * actual start while the bin is filled. */
+	size_t start = *store_end;
+	for (unsigned int i = 0; i < size; i++)
+	{
+		start += t[i].count;
+		t[i].start = start;
 	}
-	else
+
+	/* Sort the disjuncts by nearest_word, using a counting sort that
+	 * keeps the order of disjuncts with the same nearest_word. The
+	 * disjuncts are visited in reverse order, so they are collected
+	 * in reverse order of the word's disjunct list. */
+	unsigned int nw_count[MAX_SENTENCE+2] = {0};
+	Disjunct **rev = tmp;
+	Disjunct **sorted = tmp + n;
+	size_t i = n;
+
+	for (d = dlist; d != NULL; d = d->next)
+	{
+		Connector *c = (dir < 0) ? d->left : d->right;
+		if (NULL == c) continue;
+		rev[--i] = d;
+
+		/* The nearest first: ascending for the right connectors,
+		 * descending for the left ones. */
+		int key = (dir < 0) ? MAX_SENTENCE - c->nearest_word : c->nearest_word;
+		nw_count[key + 1]++;
+	}
+	for (int k = 1; k < MAX_SENTENCE+2; k++)
+		nw_count[k] += nw_count[k-1];
+	for (i = 0; i < n; i++)
+	{
+		Connector *c = (dir < 0) ? rev[i]->left : rev[i]->right;
+		int key = (dir < 0) ? MAX_SENTENCE - c->nearest_word : c->nearest_word;
+		sorted[nw_count[key]++] = rev[i];
+	}
+
+	/* Distribute them to their bins, keeping the sort order. */
+	for (i = n; i-- > 0; )
 	{
-		*xl = add_to_left_table_list(m, *xl);
+		Connector *c = (dir < 0) ? sorted[i]->left : sorted[i]->right;
+		Match_bin *b = get_match_table_entry(ctxt->cenum, size, t, c);
+		ctxt->bin_store[--b->start] = sorted[i];
 	}
+
+	*store_end += n;
 }
 
 fast_matcher_t* alloc_fast_matcher(const Sentence sent)
 {
-	unsigned int size;
 	size_t w;
-	int len;
-	Match_node ** t;
-	Disjunct * d;
 	fast_matcher_t *ctxt;
 
 	ctxt = (fast_matcher_t *) xalloc(sizeof(fast_matcher_t));
 	ctxt->size = sent->length;
+	ctxt->cenum = sent->dict->connector_enum;
 	ctxt->l_table_size = xalloc(2 * sent->length * sizeof(unsigned int));
 	ctxt->r_table_size = ctxt->l_table_size + sent->length;
-	ctxt->l_table = xalloc(2 * sent->length * sizeof(Match_node **));
+	ctxt->l_table = xalloc(2 * sent->length * sizeof(Match_bin *));
 	ctxt->r_table = ctxt->l_table + sent->length;
-	memset(ctxt->l_table, 0, 2 * sent->length * sizeof(Match_node **));
 
 	ctxt->match_list_size = MATCH_LIST_SIZE_INIT;
 	ctxt->match_list = xalloc(ctxt->match_list_size * sizeof(*ctxt->match_list));
 	ctxt->match_list_end = 0;
 
-	for (w=0; w<sent->length; w++)
+	ctxt->ml_cache_size = ML_CACHE_SIZE_INIT;
+	ctxt->ml_cache = xalloc(ctxt->ml_cache_size * sizeof(ml_cache_entry));
+	memset(ctxt->ml_cache, 0, ctxt->ml_cache_size * sizeof(ml_cache_entry));
+	ctxt->ml_cache_count = 0;
+	ctxt->ml_store_size = MATCH_LIST_SIZE_INIT;
+	ctxt->ml_store = xalloc(ctxt->ml_store_size * sizeof(*ctxt->ml_store));
+	ctxt->ml_store[0] = NULL; /* The empty list */
+	ctxt->ml_store_end = 1;
+
+	/* All the bin tables, and all the bins, are allocated at once. */
+	ctxt->bin_table_size = 0;
+	ctxt->bin_store_size = 0;
+	int maxlen = 0;
+	for (w = 0; w < sent->length; w++)
 	{
-		len = left_disjunct_list_length(sent->word[w].d);
-		size = next_power_of_two_up(len);
-		ctxt->l_table_size[w] = size;
-		t = ctxt->l_table[w] = (Match_node **) xalloc(size * sizeof(Match_node *));
-		memset(t, 0, size * sizeof(Match_node *));
-
-		for (d = sent->word[w].d; d != NULL; d = d->next)
-		{
-			if (d->left != NULL)
-			{
-				put_into_match_table(size, t, d, d->left, -1);
-			}
-		}
-
-		len = right_disjunct_list_length(sent->word[w].d);
-		size = next_power_of_two_up(len);
-		ctxt->r_table_size[w] = size;
-		t = ctxt->r_table[w] = (Match_node **) xalloc(size * sizeof(Match_node *));
-		memset(t, 0, size * sizeof(Match_node *));
-
-		for (d = sent->word[w].d; d != NULL; d = d->next)
-		{
-			if (d->right != NULL)
-			{
-				put_into_match_table(size, t, d, d->right, 1);
-			}
-		}
+		int llen = left_disjunct_list_length(sent->word[w].d);
+		int rlen = right_disjunct_list_length(sent->word[w].d);
+
+		maxlen = MAX(maxlen, MAX(llen, rlen));
+		ctxt->l_table_size[w] = next_power_of_two_up(llen);
+		ctxt->r_table_size[w] = next_power_of_two_up(rlen);
+		ctxt->bin_table_size += ctxt->l_table_size[w] + ctxt->r_table_size[w];
+		ctxt->bin_store_size += llen + rlen;
 	}
+	ctxt->bin_table = xalloc(ctxt->bin_table_size * sizeof(Match_bin));
+	memset(ctxt->bin_table, 0, ctxt->bin_table_size * sizeof(Match_bin));
+	ctxt->bin_store = xalloc(ctxt->bin_store_size * sizeof(Disjunct *));
+
+	Disjunct **tmp = xalloc(2 * maxlen * sizeof(Disjunct *));
+	Match_bin *t = ctxt->bin_table;
+	size_t store_end = 0;
+	for (w = 0; w < sent->length; w++)
+	{
+		ctxt->l_table[w] = t;
+		build_match_table(ctxt, sent->word[w].d, ctxt->l_table_size[w], t,
+		                  -1, &store_end, tmp);
+		t += ctxt->l_table_size[w];
+
+		ctxt->r_table[w] = t;
+		build_match_table(ctxt, sent->word[w].d, ctxt->r_table_size[w], t,
+		                  1, &store_end, tmp);
+		t += ctxt->r_table_size[w];
+	}
+	xfree(tmp, 2 * maxlen * sizeof(Disjunct *));
 
 	return ctxt;
 }
@@ -338,19 +318,20 @@ static void match_stats(Connector *c1, Connector *c2)
 {
 	if (NULL == c1) printf("match_stats: cache\n");
 	if (NULL == c2) return;
-	if ((1 == c1->uc_start) && (1 == c2->uc_start) &&
+	if ((1 == connector_uc_start(c1)) && (1 == connector_uc_start(c2)) &&
 	    (c1->string[0] == c2->string[0]))
 	{
 		printf("match_stats: h/d mismatch\n");
 	}
 
-	if (0 == c1->lc_start) printf("match_stats: no lc (c1)\n");
-	if (0 == c2->lc_start) printf("match_stats: no lc (c2)\n");
+	const char *a = &c1->string[connector_uc_start(c1) + c1->uc_length];
+	const char *b = &c2->string[connector_uc_start(c2) + c2->uc_length];
+
+	if ('\0' == *a) printf("match_stats: no lc (c1)\n");
+	if ('\0' == *b) printf("match_stats: no lc (c2)\n");
 
 	if (string_set_cmp(c1->string, c2->string)) printf("match_stats: same\n");
 
-	const char *a = &c1->string[c1->lc_start];
-	const char *b = &c2->string[c2->lc_start];
 	do
 	{
 		if (*a != *b && (*a != '*') && (*b != '*')) printf("match_stats: lc false\n");
@@ -410,7 +391,7 @@ static void print_match_list(fast_matcher_t *ctxt, int id, size_t mlb, int w,
  * head/dependent indicators are in the caller function, and only when
  * connectors match here, to save CPU when the connectors don't match
  * otherwise. This is because h/d mismatch is rare.
- * FIXME: Use connector enumeration.
+ * Used only for connectors that are not enumerated (see connector-enum.c).
  */
 static bool match_lower_case(Connector *c1, Connector *c2)
 {
@@ -419,12 +400,13 @@ static bool match_lower_case(Connector *c1, Connector *c2)
 	/* If the connectors are identical, they match. */
 	if (string_set_cmp(c1->string, c2->string)) return true;
 
+	const char *a = &c1->string[connector_uc_start(c1) + c1->uc_length];
+	const char *b = &c2->string[connector_uc_start(c2) + c2->uc_length];
+
 	/* If any of the connectors doesn't have a lc part, they match */
-	if ((0 == c2->lc_start) || (0 == c1->lc_start)) return true;
+	if (('\0' == *a) || ('\0' == *b)) return true;
 
 	/* Compare the lc parts according to the connector matching rules. */
-	const char *a = &c1->string[c1->lc_start];
-	const char *b = &c2->string[c2->lc_start];
 	do
 	{
 		if (*a != *b && (*a != '*') && (*b != '*')) return false;
@@ -441,7 +423,7 @@ static bool match_lower_case(Connector *c1, Connector *c2)
  */
 static bool match_hd(Connector *c1, Connector *c2)
 {
-	if ((1 == c1->uc_start) && (1 == c2->uc_start) &&
+	if ((1 == connector_uc_start(c1)) && (1 == connector_uc_start(c2)) &&
 	    (c1->string[0] == c2->string[0]))
 	{
 		return false;
@@ -463,7 +445,8 @@ typedef struct
  * the cached result. (i.e. the caching here is almost trivial, but it
  * works well).
  */
-static bool do_match_with_cache(Connector *a, Connector *b, match_cache *c_con)
+static bool do_match_with_cache(const Connector_enum *ce,
+                                Connector *a, Connector *b, match_cache *c_con)
 {
 	/* The following uses a string-set compare - string_set_cmp() cannot
 	 * be used here because c_con->string may be NULL. */
@@ -481,7 +464,10 @@ static bool do_match_with_cache(Connector *a, Connector *b, match_cache *c_con)
 #endif /* HAVE_MAYBE_UNINITIALIZED */
 
 	/* No cache exists. Check if the connectors match and cache the result. */
-	c_con->match = match_lower_case(a, b) && match_hd(a, b);
+	if ((0 != a->id) && (0 != b->id))
+		c_con->match = connector_enum_match(ce, a->id, b->id);
+	else
+		c_con->match = match_lower_case(a, b) && match_hd(a, b);
 	c_con->string = a->string;
 
 	return c_con->match;
@@ -544,13 +530,134 @@ static bool alt_connection_possible(Connector *c1, Connector *c2,
 #endif /* ALT_CONNECTION_POSSIBLE */
 }
 
+static unsigned int ml_cache_hash(const Connector *c, int w, size_t size)
+{
+	uintptr_t h = (uintptr_t) c;
+
+	h = (h >> 4) ^ ((unsigned int) w * 0x9E3779B1);
+	h ^= h >> 13;
+	return (unsigned int) h & (size-1);
+}
+
+static void ml_cache_grow(fast_matcher_t *ctxt)
+{
+	ml_cache_entry *old_cache = ctxt->ml_cache;
+	size_t old_size = ctxt->ml_cache_size;
+
+	ctxt->ml_cache_size *= 2;
+	ctxt->ml_cache = xalloc(ctxt->ml_cache_size * sizeof(ml_cache_entry));
+	memset(ctxt->ml_cache, 0, ctxt->ml_cache_size * sizeof(ml_cache_entry));
+
+	for (size_t i = 0; i < old_size; i++)
+	{
+		ml_cache_entry *e = &old_cache[i];
+		if (NULL == e->c) continue;
+
+		size_t h = ml_cache_hash(e->c, e->w, ctxt->ml_cache_size);
+		while (NULL != ctxt->ml_cache[h].c)
+			h = (h + 1) & (ctxt->ml_cache_size-1);
+		ctxt->ml_cache[h] = *e;
+	}
+	xfree(old_cache, old_size * sizeof(ml_cache_entry));
+}
+
+static void push_ml_store_element(fast_matcher_t *ctxt, Disjunct *d)
+{
+	if (ctxt->ml_store_end >= ctxt->ml_store_size)
+	{
+		ctxt->ml_store_size *= MATCH_LIST_SIZE_INC;
+		ctxt->ml_store = realloc(ctxt->ml_store,
+		                      ctxt->ml_store_size * sizeof(*ctxt->ml_store));
+	}
+
+	ctxt->ml_store[ctxt->ml_store_end++] = d;
+}
+
+/**
+ * Return the one-sided match list of the connector c of word cw, at
+ * word w: the disjuncts of w whose connector on the side of c can
+ * connect to it. dir is -1 if cw is to the left of w, and 1 if it is
+ * to its right.
+ *
+ * do_count() reaches the same word and connector through many ranges,
+ * and the linkage extraction does that once again. So the list is
+ * computed only once, and kept in the fast matcher. The returned value
+ * is the index of the NULL-terminated list in ctxt->ml_store.
+ */
+static size_t get_one_sided_match_list(fast_matcher_t *ctxt, int w,
+                                       Connector *c, int cw, int dir)
+{
+	if (2 * ctxt->ml_cache_count >= ctxt->ml_cache_size) ml_cache_grow(ctxt);
+
+	size_t h = ml_cache_hash(c, w, ctxt->ml_cache_size);
+	for (; NULL != ctxt->ml_cache[h].c; h = (h + 1) & (ctxt->ml_cache_size-1))
+	{
+		ml_cache_entry *e = &ctxt->ml_cache[h];
+		if ((c == e->c) && (w == e->w)) return e->start;
+	}
+
+	Disjunct **bin = NULL, **bin_end = NULL;
+	int dist = (w - cw) * -dir;
+	if (dist <= c->length_limit)
+	{
+		Match_bin *b;
+		if (dir < 0)
+			b = get_match_table_entry(ctxt->cenum, ctxt->l_table_size[w], ctxt->l_table[w], c);
+		else
+			b = get_match_table_entry(ctxt->cenum, ctxt->r_table_size[w], ctxt->r_table[w], c);
+		if (NULL != b)
+		{
+			bin = &ctxt->bin_store[b->start];
+			bin_end = bin + b->count;
+		}
+	}
+
+	size_t start = ctxt->ml_store_end;
+	match_cache mc;
+	gword_cache gc;
+
+	mc.string = NULL;
+	gc.gword = NULL;
+	gc.same_alternative = false;
+	for (Disjunct **mx = bin; mx < bin_end; mx++)
+	{
+		Connector *dc = (dir < 0) ? (*mx)->left : (*mx)->right;
+
+		/* The bins are sorted by nearest_word, the nearest first. */
+		if ((dir < 0) ? (dc->nearest_word < cw) : (dc->nearest_word > cw))
+			break;
+		if (dist > dc->length_limit) continue;
+
+		if (do_match_with_cache(ctxt->cenum, dc, c, &mc) &&
+		    alt_connection_possible(dc, c, &gc))
+		{
+			push_ml_store_element(ctxt, *mx);
+		}
+	}
+
+	/* Empty lists share the NULL at the ml_store start. */
+	if (start == ctxt->ml_store_end)
+		start = 0;
+	else
+		push_ml_store_element(ctxt, NULL);
+
+	ml_cache_entry *e = &ctxt->ml_cache[h];
+	e->c = c;
+	e->w = w;
+	e->start = start;
+	ctxt->ml_cache_count++;
+
+	return start;
+}
+
 /**
  * Forms and returns a list of disjuncts coming from word w, that
  * actually matches lc or rc or both. The lw and rw are the words from
  * which lc and rc came respectively.
  *
- * The list is returned in a linked list of Match_nodes.  This list
- * contains no duplicates, because when processing the ml list, only
+ * The list is made of the one-sided match lists of lc and rc (see
+ * get_one_sided_match_list()), and is pushed on the match-list stack.
+ * It contains no duplicates, because when processing the ml list, only
  * elements whose match_left is true are included, and such elements are
  * not included again when processing the mr list.
  *
@@ -566,79 +673,47 @@ form_match_list(fast_matcher_t *ctxt, int w,
                 Connector *lc, int lw,
                 Connector *rc, int rw)
 {
-	Match_node *mx, *mr_end, **mxp;
 	size_t front = ctxt->match_list_end;
-	Match_node *ml = NULL, *mr = NULL;
-	match_cache mc;
-	gword_cache gc;
-
-	gc.same_alternative = NULL;
+	size_t ml = 0, mr = 0; /* Empty lists */
+	Disjunct **mx;
 
 #ifdef VERIFY_MATCH_LIST
-	static int id = 0;
+	static TLS int id = 0;
 	int lid = ++id; /* A local copy, for multi-threading support. */
 #endif
 
-	/* Get the lists of candidate matching disjuncts of word w for lc and
-	 * rc.  Consider each of these lists only if the length_limit of lc
-	 * rc and also w, is not greater then the distance between their word
-	 * and the word w. */
-	if ((lc != NULL) && ((w - lw) <= lc->length_limit))
-	{
-		mxp = get_match_table_entry(ctxt->l_table_size[w], ctxt->l_table[w], lc, -1);
-		if (NULL != mxp) ml = *mxp;
-	}
-	if ((rc != NULL) && ((rw - w) <= rc->length_limit))
-	{
-		mxp = get_match_table_entry(ctxt->r_table_size[w], ctxt->r_table[w], rc, 1);
-		if (NULL != mxp) mr = *mxp;
-	}
+	if (lc != NULL) ml = get_one_sided_match_list(ctxt, w, lc, lw, -1);
+	if (rc != NULL) mr = get_one_sided_match_list(ctxt, w, rc, rw, 1);
 
-	for (mx = mr; mx != NULL; mx = mx->next)
-	{
-		if (mx->d->right->nearest_word > rw) break;
-		mx->d->match_left = false;
-	}
-	mr_end = mx;
+	for (mx = &ctxt->ml_store[mr]; NULL != *mx; mx++)
+		(*mx)->match_left = false;
 
 	/* Construct the list of things that could match the left. */
-	mc.string = NULL;
-	gc.gword = NULL;
-	for (mx = ml; mx != NULL; mx = mx->next)
+	for (mx = &ctxt->ml_store[ml]; NULL != *mx; mx++)
 	{
-		if (mx->d->left->nearest_word < lw) break;
-		if ((w - lw) > mx->d->left->length_limit) continue;
-
-		mx->d->match_left = do_match_with_cache(mx->d->left, lc, &mc) &&
-		                    alt_connection_possible(mx->d->left, lc, &gc);
-		if (!mx->d->match_left) continue;
-		mx->d->match_right = false;
+		(*mx)->match_left = true;
+		(*mx)->match_right = false;
 
 #ifdef VERIFY_MATCH_LIST
-		mx->d->match_id = lid;
+		(*mx)->match_id = lid;
 #endif
-		push_match_list_element(ctxt, mx->d);
+		push_match_list_element(ctxt, *mx);
 	}
 
 	/* Append the list of things that could match the right.
-	 * Note that it is important to set here match_right correctly even
-	 * if we are going to skip this element here because its match_left
+	 * Note that it is important to set here match_right even if we
+	 * are going to skip this element here because its match_left
 	 * is true, since then it means it is already included in the match
 	 * list. */
-	mc.string = NULL;
-	gc.gword = NULL;
-	for (mx = mr; mx != mr_end; mx = mx->next)
+	for (mx = &ctxt->ml_store[mr]; NULL != *mx; mx++)
 	{
-		if ((rw - w) > mx->d->right->length_limit) continue;
-
-		mx->d->match_right = do_match_with_cache(mx->d->right, rc, &mc) &&
-			                  alt_connection_possible(mx->d->right, rc, &gc);
-		if (!mx->d->match_right || mx->d->match_left) continue;
+		(*mx)->match_right = true;
+		if ((*mx)->match_left) continue;
 
 #ifdef VERIFY_MATCH_LIST
-		mx->d->match_id = lid;
+		(*mx)->match_id = lid;
 #endif
-		push_match_list_element(ctxt, mx->d);
+		push_match_list_element(ctxt, *mx);
 	}
 
 	push_match_list_element(ctxt, NULL);
@@ -16,20 +16,53 @@
 #include "link-includes.h"
 #include "structures.h"
 
+typedef struct
+{
+	const Connector *c;          /* NULL for an empty slot */
+	int w;
+	size_t start;                /* List index in ml_store */
+} ml_cache_entry;
+
+/**
+ * A bin of the disjuncts of a word whose connector on one side has a
+ * given upper-case part. The disjuncts themselves are in bin_store.
+ */
+typedef struct
+{
+	Connector *c;                /* A connector of this bin */
+	unsigned int start;          /* Index of its first disjunct */
+	unsigned int count;          /* 0 for an unused bin */
+} Match_bin;
+
 struct fast_matcher_s
 {
 	size_t size;
+	const Connector_enum *cenum; /* The dictionary connector enumeration */
 	unsigned int *l_table_size;  /* the sizes of the hash tables */
 	unsigned int *r_table_size;
 
-	/* the beginnings of the hash tables */
-	Match_node *** l_table;
-	Match_node *** r_table;
+	/* the beginnings of the hash tables of the bins */
+	Match_bin ** l_table;
+	Match_bin ** r_table;
+
+	/* The hash tables and the bins of all the words. */
+	Match_bin * bin_table;
+	size_t bin_table_size;
+	Disjunct ** bin_store;
+	size_t bin_store_size;
 
 	/* I'll pedantically maintain my own array of these cells */
 	Disjunct ** match_list;      /* match-list stack */
 	size_t match_list_end;       /* index to the match-list stack end */
 	size_t match_list_size;      /* number of allocated elements */
+
+	/* The one-sided match lists, by connector and word. */
+	ml_cache_entry *ml_cache;
+	size_t ml_cache_size;        /* a power of 2 */
+	size_t ml_cache_count;       /* number of used entries */
+	Disjunct ** ml_store;        /* the NULL-terminated lists */
+	size_t ml_store_end;
+	size_t ml_store_size;
 };
 
 /* See the source file for documentation. */
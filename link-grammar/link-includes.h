@@ -143,6 +143,18 @@ link_public_api(void)
      parse_options_set_linkage_limit(Parse_Options opts, int linkage_limit);
 link_public_api(int)
      parse_options_get_linkage_limit(Parse_Options opts);
+link_public_api(void)
+     parse_options_set_kbest(Parse_Options opts, bool val);
+link_public_api(bool)
+     parse_options_get_kbest(Parse_Options opts);
+link_public_api(void)
+     parse_options_set_lazy_linkages(Parse_Options opts, bool val);
+link_public_api(bool)
+     parse_options_get_lazy_linkages(Parse_Options opts);
+link_public_api(void)
+     parse_options_set_parse_forest(Parse_Options opts, bool val);
+link_public_api(bool)
+     parse_options_get_parse_forest(Parse_Options opts);
 link_public_api(void)
      parse_options_set_disjunct_cost(Parse_Options opts, double disjunct_cost);
 link_public_api(double)
@@ -209,6 +221,10 @@ link_public_api(void)
      parse_options_set_repeatable_rand(Parse_Options opts, bool val);
 link_public_api(bool)
      parse_options_get_repeatable_rand(Parse_Options opts);
+link_public_api(void)
+     parse_options_set_threads(Parse_Options opts, int threads);
+link_public_api(int)
+     parse_options_get_threads(Parse_Options opts);
 link_public_api(void)
      parse_options_reset_resources(Parse_Options opts);
 
@@ -255,6 +271,8 @@ link_public_api(int)
      sentence_split(Sentence sent, Parse_Options opts);
 link_public_api(int)
      sentence_parse(Sentence sent, Parse_Options opts);
+link_public_api(void)
+     sentence_parse_cancel(Sentence sent);
 link_public_api(int)
      sentence_length(Sentence sent);
 link_public_api(int)
@@ -288,6 +306,8 @@ typedef size_t LinkIdx;
 
 link_public_api(Linkage)
      linkage_create(LinkageIdx linkage_num, Sentence sent, Parse_Options opts);
+link_public_api(Linkage)
+     sentence_next_linkage(Sentence sent, Parse_Options opts);
 link_public_api(void)
      linkage_delete(Linkage linkage);
 link_public_api(size_t)
@@ -359,6 +379,68 @@ link_public_api(double)
 link_public_api(const char *)
      linkage_get_violation_name(const Linkage linkage);
 
+/**********************************************************************
+ *
+ * Functions that access the packed parse forest of a Sentence.
+ * The forest represents all the parses of the sentence at once, in
+ * size polynomial in its length: each node is a range of words, and
+ * each of its choices is a word in this range, with its links to the
+ * range ends, together with a left and a right sub-node. The parses of
+ * a node are those of all its choices. The sub-nodes of a node always
+ * precede it, and the root node is the last one.
+ *
+ ***********************************************************************/
+
+typedef struct Parse_forest_s * Parse_forest;
+typedef size_t ForestIdx;
+
+/* Returned instead of a node or a choice index for a bad argument.
+ * (0 cannot be used for that, as it is a valid index.) */
+#define PARSE_FOREST_BAD_INDEX ((ForestIdx)-1)
+
+link_public_api(Parse_forest)
+     sentence_get_parse_forest(Sentence sent);
+link_public_api(size_t)
+     parse_forest_get_num_nodes(const Parse_forest pf);
+link_public_api(size_t)
+     parse_forest_get_num_choices(const Parse_forest pf);
+link_public_api(size_t)
+     parse_forest_get_null_count(const Parse_forest pf);
+link_public_api(int)
+     parse_forest_get_node_lword(const Parse_forest pf, ForestIdx node);
+link_public_api(int)
+     parse_forest_get_node_rword(const Parse_forest pf, ForestIdx node);
+link_public_api(double)
+     parse_forest_get_node_count(const Parse_forest pf, ForestIdx node);
+link_public_api(double)
+     parse_forest_get_node_cost(const Parse_forest pf, ForestIdx node);
+link_public_api(ForestIdx)
+     parse_forest_get_node_first_choice(const Parse_forest pf, ForestIdx node);
+link_public_api(size_t)
+     parse_forest_get_node_num_choices(const Parse_forest pf, ForestIdx node);
+link_public_api(ForestIdx)
+     parse_forest_get_choice_left(const Parse_forest pf, ForestIdx choice);
+link_public_api(ForestIdx)
+     parse_forest_get_choice_right(const Parse_forest pf, ForestIdx choice);
+link_public_api(int)
+     parse_forest_get_choice_word(const Parse_forest pf, ForestIdx choice);
+link_public_api(const char *)
+     parse_forest_get_choice_word_string(const Parse_forest pf, ForestIdx choice);
+link_public_api(double)
+     parse_forest_get_choice_disjunct_cost(const Parse_forest pf, ForestIdx choice);
+link_public_api(size_t)
+     parse_forest_get_choice_num_links(const Parse_forest pf, ForestIdx choice);
+link_public_api(int)
+     parse_forest_get_choice_link_lword(const Parse_forest pf, ForestIdx choice, LinkIdx index);
+link_public_api(int)
+     parse_forest_get_choice_link_rword(const Parse_forest pf, ForestIdx choice, LinkIdx index);
+link_public_api(const char *)
+     parse_forest_get_choice_link_label(const Parse_forest pf, ForestIdx choice, LinkIdx index);
+link_public_api(char *)
+     parse_forest_print(const Parse_forest pf);
+link_public_api(void)
+     parse_forest_free_print(char *str);
+
 
 /**********************************************************************
  *
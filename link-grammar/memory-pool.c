@@ -0,0 +1,136 @@
+/*************************************************************************/
+/* Copyright (c) 2017 Linas Vepstas                                      */
+/* All rights reserved                                                   */
+/*                                                                       */
+/* Use of the link grammar parsing system is subject to the terms of the */
+/* license set forth in the LICENSE file included with this software.    */
+/* This license allows free redistribution and use in source and binary  */
+/* forms, with or without modification, subject to certain conditions.   */
+/*                                                                       */
+/*************************************************************************/
+
+#include <string.h>
+
+#include "error.h"
+#include "externs.h"
+#include "memory-pool.h"
+#include "utilities.h"
+
+#define D_MEMPOOL 8
+
+/* The first bytes of each block hold the pointer to the next block. */
+#define BLOCK_HEADER_SIZE POOL_ALIGNMENT
+#define NEXT_BLOCK(b) (*(char **)(b))
+
+static size_t align_size(size_t sz)
+{
+	return (sz + POOL_ALIGNMENT - 1) & ~(size_t)(POOL_ALIGNMENT - 1);
+}
+
+/**
+ * Create a new memory pool.
+ * @param name Pool name, for debug messages.
+ * @param num_elements Number of elements per allocation block.
+ * @param element_size Size of each element.
+ */
+Pool_desc *pool_new(const char *name, size_t num_elements, size_t element_size)
+{
+	Pool_desc *mp = (Pool_desc *) xalloc(sizeof(Pool_desc));
+
+	if (0 == num_elements) num_elements = 1;
+	mp->name = name;
+	mp->element_size = align_size(element_size);
+	mp->num_elements = num_elements;
+	mp->block_size = BLOCK_HEADER_SIZE + mp->element_size * num_elements;
+	mp->chain = NULL;
+	mp->ring = NULL;
+	mp->alloc_next = NULL;
+	mp->curr_elements = 0;
+
+	lgdebug(+D_MEMPOOL, "%s: %zu elements of %zu bytes per block\n",
+	        name, num_elements, mp->element_size);
+	return mp;
+}
+
+/**
+ * Return a new (uninitialized) element from the pool.
+ */
+void *pool_alloc(Pool_desc *mp)
+{
+	if ((NULL == mp->alloc_next) ||
+	    (mp->alloc_next == mp->ring + mp->block_size))
+	{
+		/* The current block is exhausted. After pool_reuse(), the
+		 * next block may already exist; else allocate a new one. */
+		char *next = (NULL == mp->ring) ? mp->chain : NEXT_BLOCK(mp->ring);
+
+		if (NULL == next)
+		{
+			next = (char *) xalloc(mp->block_size);
+			NEXT_BLOCK(next) = NULL;
+			if (NULL == mp->ring)
+				mp->chain = next;
+			else
+				NEXT_BLOCK(mp->ring) = next;
+		}
+		mp->ring = next;
+		mp->alloc_next = next + BLOCK_HEADER_SIZE;
+	}
+
+	void *e = mp->alloc_next;
+	mp->alloc_next += mp->element_size;
+	mp->curr_elements++;
+
+	return e;
+}
+
+/**
+ * Make all the elements available again, keeping the blocks allocated.
+ * Previously returned element addresses become invalid.
+ */
+void pool_reuse(Pool_desc *mp)
+{
+	lgdebug(+D_MEMPOOL, "%s: reuse after %zu elements\n",
+	        mp->name, mp->curr_elements);
+	mp->ring = NULL;
+	mp->alloc_next = NULL;
+	mp->curr_elements = 0;
+}
+
+static void free_blocks(Pool_desc *mp)
+{
+	char *b, *next;
+	for (b = mp->chain; NULL != b; b = next)
+	{
+		next = NEXT_BLOCK(b);
+		xfree(b, mp->block_size);
+	}
+	mp->chain = NULL;
+}
+
+/**
+ * Free all the pool blocks, but keep the pool for further allocations.
+ * Previously returned element addresses become invalid.
+ */
+void pool_release(Pool_desc *mp)
+{
+	lgdebug(+D_MEMPOOL, "%s: release after %zu elements\n",
+	        mp->name, mp->curr_elements);
+	free_blocks(mp);
+	mp->ring = NULL;
+	mp->alloc_next = NULL;
+	mp->curr_elements = 0;
+}
+
+/**
+ * Free all the pool blocks and the pool descriptor.
+ */
+void pool_delete(Pool_desc *mp)
+{
+	if (NULL == mp) return;
+	lgdebug(+D_MEMPOOL, "%s: delete after %zu elements\n",
+	        mp->name, mp->curr_elements);
+
+	free_blocks(mp);
+	xfree(mp, sizeof(Pool_desc));
+}
@@ -0,0 +1,47 @@
+/*************************************************************************/
+/* Copyright (c) 2017 Linas Vepstas                                      */
+/* All rights reserved                                                   */
+/*                                                                       */
+/* Use of the link grammar parsing system is subject to the terms of the */
+/* license set forth in the LICENSE file included with this software.    */
+/* This license allows free redistribution and use in source and binary  */
+/* forms, with or without modification, subject to certain conditions.   */
+/*                                                                       */
+/*************************************************************************/
+
+#ifndef _MEMORY_POOL_H
+#define _MEMORY_POOL_H
+
+#include <stddef.h>
+
+/* Alignment of the elements handed out by pool_alloc(). */
+#define POOL_ALIGNMENT 16
+
+typedef struct Pool_desc_s Pool_desc;
+
+/**
+ * A simple fixed-size-element allocator.
+ * Elements are carved out of large blocks, and are never individually
+ * freed. The whole pool is released (or recycled) at once. Element
+ * addresses remain valid until pool_reuse(), pool_release() or
+ * pool_delete().
+ */
+struct Pool_desc_s
+{
+	const char *name;       /* For debug */
+	char *chain;            /* Block chain; link is at the block start */
+	char *ring;             /* Current block for allocation */
+	char *alloc_next;       /* Next element to be handed out */
+	size_t element_size;    /* Aligned element size */
+	size_t block_size;      /* Including the chain link */
+	size_t num_elements;    /* Elements per block */
+	size_t curr_elements;   /* Elements handed out so far */
+};
+
+Pool_desc *pool_new(const char *name, size_t num_elements, size_t element_size);
+void *pool_alloc(Pool_desc *);
+void pool_reuse(Pool_desc *);
+void pool_release(Pool_desc *);
+void pool_delete(Pool_desc *);
+
+#endif /* _MEMORY_POOL_H */
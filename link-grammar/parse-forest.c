@@ -0,0 +1,425 @@
+/*************************************************************************/
+/* Copyright (c) 2017 Linas Vepstas                                      */
+/* All rights reserved                                                   */
+/*                                                                       */
+/* Use of the link grammar parsing system is subject to the terms of the */
+/* license set forth in the LICENSE file included with this software.    */
+/* This license allows free redistribution and use in source and binary  */
+/* forms, with or without modification, subject to certain conditions.   */
+/*                                                                       */
+/*************************************************************************/
+
+#include <stdint.h>
+#include <string.h>
+
+#include "analyze-linkage.h"
+#include "parse-forest.h"
+#include "print-util.h"
+#include "structures.h"
+#include "utilities.h"
+
+/*
+ * The parse set of a sentence is a DAG: the same sub-set is shared by
+ * all the choices that use it. It represents all the parses in space
+ * that is polynomial in the sentence length, while the number of parses
+ * may be exponential in it. The packed forest keeps this sharing, so
+ * clients can run dynamic programming over all the parses (e.g. to
+ * compute inside scores, or to rerank) without enumerating them.
+ */
+
+/* Maps the parse sets that have been packed to their node indices. */
+typedef struct
+{
+	const Parse_set **set;
+	unsigned int *index;
+	size_t size;
+	size_t population;
+} Set_map;
+
+static size_t set_map_slot(const Set_map *map, const Parse_set *set)
+{
+	size_t h = (size_t)((((uintptr_t)set) >> 4) * 0x9E3779B1u);
+
+	for (h &= map->size - 1; NULL != map->set[h]; h = (h + 1) & (map->size - 1))
+	{
+		if (set == map->set[h]) break;
+	}
+	return h;
+}
+
+static void set_map_init(Set_map *map, size_t size)
+{
+	map->size = size;
+	map->population = 0;
+	map->set = (const Parse_set **) xalloc(size * sizeof(Parse_set *));
+	memset(map->set, 0, size * sizeof(Parse_set *));
+	map->index = (unsigned int *) xalloc(size * sizeof(unsigned int));
+}
+
+static void set_map_free(Set_map *map)
+{
+	xfree(map->set, map->size * sizeof(Parse_set *));
+	xfree(map->index, map->size * sizeof(unsigned int));
+}
+
+static void set_map_add(Set_map *map, const Parse_set *set, unsigned int index)
+{
+	if (2 * (map->population + 1) > map->size)
+	{
+		Set_map old = *map;
+
+		set_map_init(map, 2 * old.size);
+		for (size_t i = 0; i < old.size; i++)
+		{
+			if (NULL == old.set[i]) continue;
+			size_t h = set_map_slot(map, old.set[i]);
+			map->set[h] = old.set[i];
+			map->index[h] = old.index[i];
+		}
+		map->population = old.population;
+		set_map_free(&old);
+	}
+
+	size_t h = set_map_slot(map, set);
+	map->set[h] = set;
+	map->index[h] = index;
+	map->population++;
+}
+
+static unsigned int set_map_index(const Set_map *map, const Parse_set *set)
+{
+	return map->index[set_map_slot(map, set)];
+}
+
+/**
+ * Pack the given parse set, after its sub-sets, unless it has already
+ * been packed. Return its node index.
+ */
+static unsigned int pack_parse_set(Parse_forest pf, Set_map *map,
+                                   const Parse_set *set, String_set *sset)
+{
+	size_t h = set_map_slot(map, set);
+	if (NULL != map->set[h]) return map->index[h];
+
+	Parse_choice *pc;
+	for (pc = set->first; pc != NULL; pc = pc->next)
+	{
+		pack_parse_set(pf, map, pc->set[0], sset);
+		pack_parse_set(pf, map, pc->set[1], sset);
+	}
+
+	if (pf->num_nodes == pf->node_size)
+	{
+		pf->node_size = 2 * pf->node_size + 64;
+		pf->node = realloc(pf->node, pf->node_size * sizeof(Forest_node));
+	}
+	Forest_node *fn = &pf->node[pf->num_nodes];
+	fn->lw = set->lw;
+	fn->rw = set->rw;
+	fn->count = set->count;
+	fn->cost = 0.0;
+	fn->first_choice = pf->num_choices;
+	fn->num_choices = 0;
+
+	for (pc = set->first; pc != NULL; pc = pc->next)
+	{
+		if (pf->num_choices == pf->choice_size)
+		{
+			pf->choice_size = 2 * pf->choice_size + 64;
+			pf->choice = realloc(pf->choice, pf->choice_size * sizeof(Forest_choice));
+		}
+		Forest_choice *fc = &pf->choice[pf->num_choices++];
+
+		fc->node[0] = set_map_index(map, pc->set[0]);
+		fc->node[1] = set_map_index(map, pc->set[1]);
+		fc->word = pc->set[0]->rw;
+		fc->cost = (NULL == pc->md) ? 0.0 : pc->md->cost;
+		fc->word_string = (NULL == pc->md) ? NULL : pc->md->string;
+		fc->num_links = 0;
+		for (int i = 0; i < 2; i++)
+		{
+			if (NULL == pc->link[i].lc) continue;
+			Forest_link *fl = &fc->link[fc->num_links++];
+			fl->lw = pc->link[i].lw;
+			fl->rw = pc->link[i].rw;
+			fl->label = compute_link_name(pc->link[i].lc, pc->link[i].rc, sset);
+		}
+
+		double cost = fc->cost +
+			pf->node[fc->node[0]].cost + pf->node[fc->node[1]].cost;
+		if ((0 == fn->num_choices) || (cost < fn->cost)) fn->cost = cost;
+		fn->num_choices++;
+	}
+
+	set_map_add(map, set, pf->num_nodes);
+	return pf->num_nodes++;
+}
+
+/**
+ * Pack the parse set of the sentence, for sentence_get_parse_forest().
+ * The link names are put in the sentence string set. Return NULL if
+ * there is no parse set.
+ */
+Parse_forest parse_forest_new(Sentence sent)
+{
+	Parse_forest pf;
+	Set_map map;
+
+	if ((NULL == sent->parse_info) || (NULL == sent->parse_info->parse_set))
+		return NULL;
+
+	pf = (Parse_forest) xalloc(sizeof(struct Parse_forest_s));
+	memset(pf, 0, sizeof(struct Parse_forest_s));
+	pf->null_count = sent->null_count;
+
+	set_map_init(&map, 1024);
+	pack_parse_set(pf, &map, sent->parse_info->parse_set, sent->string_set);
+	set_map_free(&map);
+
+	return pf;
+}
+
+void parse_forest_delete(Parse_forest pf)
+{
+	if (NULL == pf) return;
+	free(pf->node);
+	free(pf->choice);
+	xfree(pf, sizeof(struct Parse_forest_s));
+}
+
+/* ======================================================== */
+/* Public API */
+
+/**
+ * The packed parse forest of the last sentence_parse(), if the
+ * parse_forest parse option has been set, else NULL. It is also NULL
+ * if the sentence has no linkages, and when using the SAT parser.
+ * The forest belongs to the sentence, and is valid until the sentence
+ * is parsed again or deleted.
+ */
+Parse_forest sentence_get_parse_forest(Sentence sent)
+{
+	if (NULL == sent) return NULL;
+	return sent->parse_forest;
+}
+
+size_t parse_forest_get_num_nodes(const Parse_forest pf)
+{
+	if (NULL == pf) return 0;
+	return pf->num_nodes;
+}
+
+size_t parse_forest_get_num_choices(const Parse_forest pf)
+{
+	if (NULL == pf) return 0;
+	return pf->num_choices;
+}
+
+/**
+ * The number of null (unlinked) words of the parses of the forest.
+ */
+size_t parse_forest_get_null_count(const Parse_forest pf)
+{
+	if (NULL == pf) return 0;
+	return pf->null_count;
+}
+
+static inline bool verify_node_index(const Parse_forest pf, ForestIdx n)
+{
+	if (NULL == pf) return false;
+	if (n >= pf->num_nodes) return false;
+	return true;
+}
+
+static inline bool verify_choice_index(const Parse_forest pf, ForestIdx c)
+{
+	if (NULL == pf) return false;
+	if (c >= pf->num_choices) return false;
+	return true;
+}
+
+/**
+ * The words of a node are between its left and right words, exclusive.
+ * The root is the last node, and spans from -1 to the sentence length.
+ * Return -2 for a bad node index.
+ */
+int parse_forest_get_node_lword(const Parse_forest pf, ForestIdx n)
+{
+	if (!verify_node_index(pf, n)) return -2;
+	return pf->node[n].lw;
+}
+
+int parse_forest_get_node_rword(const Parse_forest pf, ForestIdx n)
+{
+	if (!verify_node_index(pf, n)) return -2;
+	return pf->node[n].rw;
+}
+
+/**
+ * The number of parses of the node. It is a double, because it may not
+ * fit in an int (it is not exact if the parse count has overflowed).
+ */
+double parse_forest_get_node_count(const Parse_forest pf, ForestIdx n)
+{
+	if (!verify_node_index(pf, n)) return 0.0;
+	return (double) pf->node[n].count;
+}
+
+/**
+ * The lowest disjunct cost of the parses of the node.
+ */
+double parse_forest_get_node_cost(const Parse_forest pf, ForestIdx n)
+{
+	if (!verify_node_index(pf, n)) return 0.0;
+	return pf->node[n].cost;
+}
+
+/**
+ * The choices of a node are consecutive. A node without choices has a
+ * single, empty, parse.
+ * Return PARSE_FOREST_BAD_INDEX for a bad node index.
+ */
+ForestIdx parse_forest_get_node_first_choice(const Parse_forest pf, ForestIdx n)
+{
+	if (!verify_node_index(pf, n)) return PARSE_FOREST_BAD_INDEX;
+	return pf->node[n].first_choice;
+}
+
+size_t parse_forest_get_node_num_choices(const Parse_forest pf, ForestIdx n)
+{
+	if (!verify_node_index(pf, n)) return 0;
+	return pf->node[n].num_choices;
+}
+
+/**
+ * A choice splits its node at its word into a left and a right
+ * sub-node; the parses of the choice are all the combinations of
+ * their parses. The sub-nodes precede the node.
+ * Return PARSE_FOREST_BAD_INDEX for a bad choice index.
+ */
+ForestIdx parse_forest_get_choice_left(const Parse_forest pf, ForestIdx c)
+{
+	if (!verify_choice_index(pf, c)) return PARSE_FOREST_BAD_INDEX;
+	return pf->choice[c].node[0];
+}
+
+ForestIdx parse_forest_get_choice_right(const Parse_forest pf, ForestIdx c)
+{
+	if (!verify_choice_index(pf, c)) return PARSE_FOREST_BAD_INDEX;
+	return pf->choice[c].node[1];
+}
+
+int parse_forest_get_choice_word(const Parse_forest pf, ForestIdx c)
+{
+	if (!verify_choice_index(pf, c)) return -2;
+	return pf->choice[c].word;
+}
+
+/**
+ * The dictionary word of the disjunct of the choice word, or NULL if
+ * the word is not linked in the parses of the choice.
+ */
+const char * parse_forest_get_choice_word_string(const Parse_forest pf, ForestIdx c)
+{
+	if (!verify_choice_index(pf, c)) return NULL;
+	return pf->choice[c].word_string;
+}
+
+double parse_forest_get_choice_disjunct_cost(const Parse_forest pf, ForestIdx c)
+{
+	if (!verify_choice_index(pf, c)) return 0.0;
+	return pf->choice[c].cost;
+}
+
+/**
+ * The links of the choice word to the words at the ends of its node.
+ */
+size_t parse_forest_get_choice_num_links(const Parse_forest pf, ForestIdx c)
+{
+	if (!verify_choice_index(pf, c)) return 0;
+	return pf->choice[c].num_links;
+}
+
+static inline const Forest_link *choice_link(const Parse_forest pf,
+                                             ForestIdx c, LinkIdx i)
+{
+	if (!verify_choice_index(pf, c)) return NULL;
+	if (i >= pf->choice[c].num_links) return NULL;
+	return &pf->choice[c].link[i];
+}
+
+int parse_forest_get_choice_link_lword(const Parse_forest pf, ForestIdx c, LinkIdx i)
+{
+	const Forest_link *fl = choice_link(pf, c, i);
+	if (NULL == fl) return -2;
+	return fl->lw;
+}
+
+int parse_forest_get_choice_link_rword(const Parse_forest pf, ForestIdx c, LinkIdx i)
+{
+	const Forest_link *fl = choice_link(pf, c, i);
+	if (NULL == fl) return -2;
+	return fl->rw;
+}
+
+const char * parse_forest_get_choice_link_label(const Parse_forest pf, ForestIdx c, LinkIdx i)
+{
+	const Forest_link *fl = choice_link(pf, c, i);
+	if (NULL == fl) return NULL;
+	return fl->label;
+}
+
+/**
+ * Serialize the forest as text: a header line, then a line per node,
+ * and then a line per choice, in index order:
+ *   forest <num_nodes> <num_choices> <null_count>
+ *   N <lword> <rword> <count> <cost> <first_choice> <num_choices>
+ *   C <left> <right> <word> <cost> <word_string> [<lword> <rword> <label>]...
+ * A missing word string is printed as "-".
+ */
+char * parse_forest_print(const Parse_forest pf)
+{
+	char *str;
+	String *s = string_new();
+
+	if (NULL == pf)
+	{
+		append_string(s, "forest 0 0 0\n");
+	}
+	else
+	{
+		append_string(s, "forest %zu %zu %zu\n",
+		              pf->num_nodes, pf->num_choices, pf->null_count);
+
+		for (size_t n = 0; n < pf->num_nodes; n++)
+		{
+			const Forest_node *fn = &pf->node[n];
+			append_string(s, "N %d %d %lld %.3f %u %u\n", fn->lw, fn->rw,
+			              (long long) fn->count, fn->cost,
+			              fn->first_choice, fn->num_choices);
+		}
+
+		for (size_t c = 0; c < pf->num_choices; c++)
+		{
+			const Forest_choice *fc = &pf->choice[c];
+			append_string(s, "C %u %u %d %.3f %s", fc->node[0], fc->node[1],
+			              fc->word, fc->cost,
+			              (NULL == fc->word_string) ? "-" : fc->word_string);
+			for (unsigned int i = 0; i < fc->num_links; i++)
+			{
+				append_string(s, " %d %d %s", fc->link[i].lw, fc->link[i].rw,
+				              fc->link[i].label);
+			}
+			append_string(s, "\n");
+		}
+	}
+
+	str = string_copy(s);
+	string_delete(s);
+	return str;
+}
+
+void parse_forest_free_print(char *str)
+{
+	exfree(str, strlen(str)+1);
+}
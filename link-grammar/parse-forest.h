@@ -0,0 +1,63 @@
+/*************************************************************************/
+/* Copyright (c) 2017 Linas Vepstas                                      */
+/* All rights reserved                                                   */
+/*                                                                       */
+/* Use of the link grammar parsing system is subject to the terms of the */
+/* license set forth in the LICENSE file included with this software.    */
+/* This license allows free redistribution and use in source and binary  */
+/* forms, with or without modification, subject to certain conditions.   */
+/*                                                                       */
+/*************************************************************************/
+
+#ifndef _PARSE_FOREST_H_
+#define _PARSE_FOREST_H_
+
+#include "api-structures.h"
+#include "histogram.h"
+#include "link-includes.h"
+
+/**
+ * The packed parse forest is a copy of the parse set (see
+ * extract-links.c) in flat arrays, in which the nodes and choices
+ * refer to each other by index. The sub-nodes of a node always
+ * precede it, so the root is the last node, and the choices of each
+ * node are consecutive.
+ */
+typedef struct
+{
+	short lw, rw;               /* The range of the node (exclusive) */
+	s64 count;                  /* The number of parses of the node */
+	double cost;                /* The lowest disjunct cost of these parses */
+	unsigned int first_choice;
+	unsigned int num_choices;
+} Forest_node;
+
+typedef struct
+{
+	short lw, rw;
+	const char *label;
+} Forest_link;
+
+typedef struct
+{
+	unsigned int node[2];       /* The left and right sub-nodes */
+	short word;                 /* The word between them */
+	unsigned short num_links;   /* Links of word to the node ends (0-2) */
+	double cost;                /* The disjunct cost of word */
+	const char *word_string;    /* NULL if word has no disjunct */
+	Forest_link link[2];
+} Forest_choice;
+
+struct Parse_forest_s
+{
+	Forest_node *node;
+	Forest_choice *choice;
+	size_t num_nodes, node_size;
+	size_t num_choices, choice_size;
+	size_t null_count;
+};
+
+Parse_forest parse_forest_new(Sentence);
+void parse_forest_delete(Parse_forest);
+
+#endif /* _PARSE_FOREST_H_ */
@@ -65,34 +65,115 @@ bool post_process_match(const char *s, const char *t)
 
 /***************** utility routines (not exported) ***********************/
 
+#define LC_INITLEN 64
+
+static size_t link_class_hash(const char *name)
+{
+	uintptr_t h = (uintptr_t)name;
+	return (size_t)(h ^ (h >> 7) ^ (h >> 17));
+}
+
+static void free_link_classes(Postprocessor *pp)
+{
+	size_t i;
+	for (i = 0; i < pp->lc_size; i++)
+		free(pp->link_class[i]);
+	free(pp->link_class);
+	pp->link_class = NULL;
+	pp->lc_size = 0;
+	pp->lc_count = 0;
+}
+
+static void grow_link_classes(Postprocessor *pp)
+{
+	size_t i, h;
+	size_t old_size = pp->lc_size;
+	pp_link_class **old_table = pp->link_class;
+
+	pp->lc_size = (0 == old_size) ? LC_INITLEN : 2 * old_size;
+	pp->link_class = calloc(pp->lc_size, sizeof(pp_link_class *));
+	for (i = 0; i < old_size; i++)
+	{
+		if (NULL == old_table[i]) continue;
+		h = link_class_hash(old_table[i]->name) & (pp->lc_size - 1);
+		while (NULL != pp->link_class[h]) h = (h + 1) & (pp->lc_size - 1);
+		pp->link_class[h] = old_table[i];
+	}
+	free(old_table);
+}
+
 /**
- * Returns false if the string s does not match anything in
- * the array. The array elements are post-processing symbols.
+ * Return what the rules say about the given link name. It is computed
+ * on the first use of the name, and then looked up by its address.
  */
-static int string_in_list(const char * s, const char * a[])
+static const pp_link_class *get_link_class(Postprocessor *pp,
+                                           const char *name)
 {
-	int i;
-	for (i=0; a[i] != NULL; i++)
-		if (post_process_match(a[i], s)) return true;
-	return false;
+	size_t h;
+	pp_link_class *lc;
+	size_t rule_words = pp->knowledge->rule_words;
+
+	if (2 * pp->lc_count >= pp->lc_size) grow_link_classes(pp);
+
+	h = link_class_hash(name) & (pp->lc_size - 1);
+	for (; NULL != pp->link_class[h]; h = (h + 1) & (pp->lc_size - 1))
+	{
+		if (pp->link_class[h]->name == name) return pp->link_class[h];
+	}
+
+	lc = malloc(sizeof(pp_link_class) + rule_words * sizeof(pp_bits));
+	lc->rule_bits = (pp_bits *)(lc + 1);
+	memset(lc->rule_bits, 0, rule_words * sizeof(pp_bits));
+	pp_knowledge_classify(pp->knowledge, name, lc);
+
+	pp->link_class[h] = lc;
+	pp->lc_count++;
+	return lc;
 }
 
 /**
- * Return the name of the domain associated with the provided starting
- * link. Return -1 if link isn't associated with a domain.
+ * Find the class of each link of the linkage, and the rules which
+ * its links use.
  */
-static size_t find_domain_name(Postprocessor *pp, const char *link)
+static void classify_links(Postprocessor *pp, Linkage sublinkage)
 {
-	size_t i, domain;
-	StartingLinkAndDomain *sllt = pp->knowledge->starting_link_lookup_table;
-	for (i=0;;i++)
+	size_t link, w;
+	PP_data *pp_data = &pp->pp_data;
+
+	if (pp_data->lclength < sublinkage->num_links)
+	{
+		pp_data->lclength = 2 * sublinkage->num_links;
+		pp_data->link_class = realloc(pp_data->link_class,
+			pp_data->lclength * sizeof(pp_link_class *));
+	}
+
+	memset(pp_data->linkage_rule_bits, 0,
+	       pp_data->rule_words * sizeof(pp_bits));
+	for (link = 0; link < sublinkage->num_links; link++)
 	{
-		domain = sllt[i].domain;
-		if (domain == SIZE_MAX) return SIZE_MAX;  /* hit the end-of-list sentinel */
-		if (post_process_match(sllt[i].starting_link, link)) return domain;
+		const pp_link_class *lc;
+		const char *name = sublinkage->link_array[link].link_name;
+
+		assert(sublinkage->link_array[link].lw != SIZE_MAX);
+		if (NULL == name)
+		{
+			pp_data->link_class[link] = NULL;
+			continue;
+		}
+		lc = get_link_class(pp, name);
+		pp_data->link_class[link] = lc;
+		for (w = 0; w < pp_data->rule_words; w++)
+			pp_data->linkage_rule_bits[w] |= lc->rule_bits[w];
 	}
 }
 
+static inline bool link_has_flag(const PP_data *pp_data, size_t link,
+                                 unsigned int flag)
+{
+	const pp_link_class *lc = pp_data->link_class[link];
+	return (NULL != lc) && (lc->flags & flag);
+}
+
 /** Returns true if domain d1 is contained in domain d2 */
 static int contained_in(const Domain * d1, const Domain * d2,
                         const Linkage sublinkage)
@@ -431,7 +512,12 @@ static bool apply_rules(PP_data *pp_data,
 	{
 		if (!applyfn(pp_data, sublinkage, &(rule_array[i])))
 		{
+			/* The rules are shared by the post-processing threads. */
+#ifdef USE_PTHREADS
+			__atomic_add_fetch(&rule_array[i].use_count, 1, __ATOMIC_RELAXED);
+#else
 			rule_array[i].use_count ++;
+#endif /* USE_PTHREADS */
 			return false;
 		}
 	}
@@ -472,31 +558,17 @@ apply_relevant_rules(Postprocessor *pp,
 static bool
 apply_contains_one(PP_data *pp_data, Linkage sublinkage, pp_rule *rule)
 {
-	DTreeLeaf * dtl;
-	size_t d, count;
+	size_t d;
 
 	for (d=0; d<pp_data->N_domains; d++)
 	{
-		for (dtl = pp_data->domain_array[d].child;
-		     dtl != NULL &&
-		        !post_process_match(rule->selector,
-		           sublinkage->link_array[dtl->link].link_name);
-		     dtl = dtl->next) {}
-		if (dtl != NULL)
-		{
-			/* selector link of rule appears in this domain */
-			count=0;
-			for (dtl = pp_data->domain_array[d].child; dtl != NULL; dtl = dtl->next)
-			{
-				if (string_in_list(sublinkage->link_array[dtl->link].link_name,
-				                   rule->link_array))
-				{
-					count=1;
-					break;
-				}
-			}
-			if (count == 0) return false;
-		}
+		const pp_bits *bits = &pp_data->domain_rule_bits[d * pp_data->rule_words];
+
+		/* The selector link of the rule appears in this domain,
+		 * but none of its link array. */
+		if ((bits[rule->selector_word] & rule->bit) &&
+		    !(bits[rule->link_array_word] & rule->bit))
+			return false;
 	}
 	return true;
 }
@@ -514,22 +586,13 @@ apply_contains_none(PP_data *pp_data, Linkage sublinkage, pp_rule *rule)
 
 	for (d=0; d<pp_data->N_domains; d++)
 	{
-		DTreeLeaf * dtl;
-		for (dtl = pp_data->domain_array[d].child;
-		     dtl != NULL &&
-		         !post_process_match(rule->selector,
-		                  sublinkage->link_array[dtl->link].link_name);
-		     dtl = dtl->next) {}
-		if (dtl != NULL)
-		{
-			/* selector link of rule appears in this domain */
-			for (dtl = pp_data->domain_array[d].child; dtl != NULL; dtl = dtl->next)
-			{
-				if (string_in_list(sublinkage->link_array[dtl->link].link_name,
-				                   rule->link_array))
-					return false;
-			}
-		}
+		const pp_bits *bits = &pp_data->domain_rule_bits[d * pp_data->rule_words];
+
+		/* The selector link of the rule appears in this domain,
+		 * together with a link of its link array. */
+		if ((bits[rule->selector_word] & rule->bit) &&
+		    (bits[rule->link_array_word] & rule->bit))
+			return false;
 	}
 	return true;
 }
@@ -542,26 +605,12 @@ apply_contains_none(PP_data *pp_data, Linkage sublinkage, pp_rule *rule)
 static bool
 apply_contains_one_globally(PP_data *pp_data, Linkage sublinkage, pp_rule *rule)
 {
-	size_t i, j, count;
-	for (i = 0; i < sublinkage->num_links; i++)
-	{
-		assert(sublinkage->link_array[i].lw != SIZE_MAX);
-		if (post_process_match(rule->selector, sublinkage->link_array[i].link_name)) break;
-	}
-	if (i == sublinkage->num_links) return true;
+	const pp_bits *bits = pp_data->linkage_rule_bits;
+
+	if (!(bits[rule->selector_word] & rule->bit)) return true;
 
 	/* selector link of rule appears in sentence */
-	count = 0;
-	for (j = 0; j < sublinkage->num_links && count == 0; j++)
-	{
-		assert(sublinkage->link_array[j].lw != SIZE_MAX);
-		if (string_in_list(sublinkage->link_array[j].link_name, rule->link_array))
-		{
-			count = 1;
-			break;
-		}
-	}
-	if (count == 0) return false; else return true;
+	return (bits[rule->link_array_word] & rule->bit) != 0;
 }
 
 /**
@@ -682,8 +731,7 @@ static void build_graph(Postprocessor *pp, Linkage sublinkage)
 	{
 		assert (sublinkage->link_array[link].lw != SIZE_MAX);
 		if (NULL == sublinkage->link_array[link].link_name) continue;
-		if (pp_linkset_match(pp->knowledge->ignore_these_links,
-		                     sublinkage->link_array[link].link_name))
+		if (link_has_flag(pp_data, link, PP_IGNORE))
 		{
 			lol = (List_o_links *) malloc(sizeof(List_o_links));
 			lol->next = pp_data->links_to_ignore;
@@ -707,8 +755,8 @@ static void build_graph(Postprocessor *pp, Linkage sublinkage)
 	}
 }
 
-static void setup_domain_array(Postprocessor *pp,
-                               const char *string, int start_link)
+static void setup_domain_array(Postprocessor *pp, const char *string,
+                               int type, int start_link)
 {
 	PP_data *pp_data = &pp->pp_data;
 	size_t n = pp_data->N_domains;
@@ -730,6 +778,12 @@ static void setup_domain_array(Postprocessor *pp,
 	pp_data->domain_array[n].lol    = NULL;
 	pp_data->domain_array[n].size   = 0;
 	pp_data->domain_array[n].start_link = start_link;
+	pp_data->domain_array[n].type   = type;
+
+	/* sanity check: all links in all domains have a legal domain name */
+	if (-1 == type)
+		prt_error("Error: post_process(): Need an entry for %s in LINK_TYPE_TABLE\n",
+		          string);
 
 	pp_data->N_domains++;
 	assert(pp_data->N_domains<PP_MAX_DOMAINS, "raise value of PP_MAX_DOMAINS");
@@ -765,8 +819,7 @@ static void depth_first_search(Postprocessor *pp, Linkage sublinkage,
 	{
 		if (!pp_data->visited[lol->word] && (lol->word != root) &&
 		       !(lol->word < root && lol->word < w &&
-		       pp_linkset_match(pp->knowledge->restricted_links,
-		                sublinkage->link_array[lol->link].link_name)))
+		       link_has_flag(pp_data, lol->link, PP_RESTRICTED)))
 		{
 			depth_first_search(pp, sublinkage, lol->word, root, start_link);
 		}
@@ -793,8 +846,7 @@ static void bad_depth_first_search(Postprocessor *pp, Linkage sublinkage,
 		assert(lol->word < pp_data->num_words, "Bad word index");
 		if ((!pp_data->visited[lol->word]) && !(w == root && lol->word < w) &&
 		     !(lol->word < root && lol->word < w &&
-		          pp_linkset_match(pp->knowledge->restricted_links,
-		                sublinkage->link_array[lol->link].link_name)))
+		          link_has_flag(pp_data, lol->link, PP_RESTRICTED)))
 		{
 			bad_depth_first_search(pp, sublinkage, lol->word, root, start_link);
 		}
@@ -822,8 +874,7 @@ static void d_depth_first_search(Postprocessor *pp, Linkage sublinkage,
 		if (!pp_data->visited[lol->word] && !(w == root && lol->word >= right) &&
 		    !(w == root && lol->word < root) &&
 		       !(lol->word < root && lol->word < w &&
-		          pp_linkset_match(pp->knowledge->restricted_links,
-		                   sublinkage->link_array[lol->link].link_name)))
+		          link_has_flag(pp_data, lol->link, PP_RESTRICTED)))
 		{
 			d_depth_first_search(pp,sublinkage,lol->word,root,right,start_link);
 		}
@@ -862,8 +913,9 @@ static int domain_compare(const Domain * d1, const Domain * d2)
 
 static void build_domains(Postprocessor *pp, Linkage sublinkage)
 {
-	size_t link, i, d;
+	size_t link;
 	const char *s;
+	const pp_link_class *lc;
 	PP_data *pp_data = &pp->pp_data;
 
 	pp_data->N_domains = 0;
@@ -873,12 +925,13 @@ static void build_domains(Postprocessor *pp, Linkage sublinkage)
 		assert (sublinkage->link_array[link].lw != SIZE_MAX);
 		if (NULL == sublinkage->link_array[link].link_name) continue;
 		s = sublinkage->link_array[link].link_name;
+		lc = pp_data->link_class[link];
 
-		if (pp_linkset_match(pp->knowledge->ignore_these_links, s)) continue;
-		if (pp_linkset_match(pp->knowledge->domain_starter_links, s))
+		if (lc->flags & PP_IGNORE) continue;
+		if (lc->flags & PP_DOMAIN_STARTER)
 		{
-			setup_domain_array(pp, s, link);
-			if (pp_linkset_match(pp->knowledge->domain_contains_links, s))
+			setup_domain_array(pp, s, lc->domain, link);
+			if (lc->flags & PP_DOMAIN_CONTAINS)
 				add_link_to_domain(pp_data, link);
 
 			clear_visited(pp_data);
@@ -886,9 +939,9 @@ static void build_domains(Postprocessor *pp, Linkage sublinkage)
 			                   sublinkage->link_array[link].lw, link);
 		}
 		else
-		if (pp_linkset_match(pp->knowledge->urfl_domain_starter_links, s))
+		if (lc->flags & PP_URFL_DOMAIN_STARTER)
 		{
-			setup_domain_array(pp, s, link);
+			setup_domain_array(pp, s, lc->domain, link);
 			/* always add the starter link to its urfl domain */
 			add_link_to_domain(pp_data, link);
 
@@ -897,9 +950,9 @@ static void build_domains(Postprocessor *pp, Linkage sublinkage)
 			                       sublinkage->link_array[link].lw, link);
 		}
 		else
-		if (pp_linkset_match(pp->knowledge->urfl_only_domain_starter_links, s))
+		if (lc->flags & PP_URFL_ONLY_DOMAIN_STARTER)
 		{
-			setup_domain_array(pp, s, link);
+			setup_domain_array(pp, s, lc->domain, link);
 			/* do not add the starter link to its urfl_only domain */
 			clear_visited(pp_data);
 			d_depth_first_search(pp, sublinkage, sublinkage->link_array[link].lw,
@@ -907,9 +960,9 @@ static void build_domains(Postprocessor *pp, Linkage sublinkage)
 			                     sublinkage->link_array[link].rw, link);
 		}
 		else
-		if (pp_linkset_match(pp->knowledge->left_domain_starter_links, s))
+		if (lc->flags & PP_LEFT_DOMAIN_STARTER)
 		{
-			setup_domain_array(pp, s, link);
+			setup_domain_array(pp, s, lc->domain, link);
 			/* do not add the starter link to a left domain */
 			clear_visited(pp_data);
 			left_depth_first_search(pp, sublinkage, sublinkage->link_array[link].lw,
@@ -922,21 +975,11 @@ static void build_domains(Postprocessor *pp, Linkage sublinkage)
 		pp_data->N_domains,
 		sizeof(Domain),
 		(int (*)(const void *, const void *)) domain_compare);
-
-	/* sanity check: all links in all domains have a legal domain name */
-	for (d = 0; d < pp_data->N_domains; d++)
-	{
-		i = find_domain_name(pp, pp_data->domain_array[d].string);
-		if (i == SIZE_MAX)
-			prt_error("Error: post_process(): Need an entry for %s in LINK_TYPE_TABLE\n",
-			          pp_data->domain_array[d].string);
-		pp_data->domain_array[d].type = i;
-	}
 }
 
 static void build_domain_forest(PP_data *pp_data, Linkage sublinkage)
 {
-	size_t d, d1, link;
+	size_t d, d1, link, w;
 	DTreeLeaf * dtl;
 
 	if (pp_data->N_domains > 0)
@@ -965,6 +1008,18 @@ static void build_domain_forest(PP_data *pp_data, Linkage sublinkage)
 	{
 		pp_data->domain_array[d].child = NULL;
 	}
+
+	/* Along with the leaves, collect the rules which the links of
+	 * the group of each domain use, for the contains rules. */
+	if (pp_data->drblength < pp_data->N_domains)
+	{
+		pp_data->drblength = pp_data->N_domains + DOMINC;
+		pp_data->domain_rule_bits = realloc(pp_data->domain_rule_bits,
+			pp_data->drblength * pp_data->rule_words * sizeof(pp_bits));
+	}
+	memset(pp_data->domain_rule_bits, 0,
+	       pp_data->N_domains * pp_data->rule_words * sizeof(pp_bits));
+
 	for (link=0; link < sublinkage->num_links; link++)
 	{
 		assert (sublinkage->link_array[link].lw != SIZE_MAX);
@@ -972,11 +1027,20 @@ static void build_domain_forest(PP_data *pp_data, Linkage sublinkage)
 		{
 			if (link_in_domain(link, &pp_data->domain_array[d]))
 			{
+				const pp_link_class *lc = pp_data->link_class[link];
+
 				dtl = (DTreeLeaf *) malloc(sizeof(DTreeLeaf));
 				dtl->link = link;
 				dtl->parent = &pp_data->domain_array[d];
 				dtl->next = pp_data->domain_array[d].child;
 				pp_data->domain_array[d].child = dtl;
+
+				if (NULL != lc)
+				{
+					pp_bits *bits = &pp_data->domain_rule_bits[d * pp_data->rule_words];
+					for (w = 0; w < pp_data->rule_words; w++)
+						bits[w] |= lc->rule_bits[w];
+				}
 				break;
 			}
 		}
@@ -989,6 +1053,8 @@ internal_process(Postprocessor *pp, Linkage sublinkage, const char **msg)
 	size_t i;
 	PP_data *pp_data = &pp->pp_data;
 
+	classify_links(pp, sublinkage);
+
 	/* quick test: try applying just the relevant global rules */
 	if (!apply_relevant_rules(pp, apply_contains_one_globally,
 	                          sublinkage,
@@ -1090,6 +1156,23 @@ void pp_new_domain_array(PP_data *pp_data)
 	memset(pp_data->domain_array, 0, pp_data->domlen * sizeof(Domain));
 }
 
+static void new_rule_bits(PP_data *pp_data, pp_knowledge *kno)
+{
+	pp_data->rule_words = kno->rule_words;
+	pp_data->linkage_rule_bits = malloc(kno->rule_words * sizeof(pp_bits));
+	pp_data->domain_rule_bits = NULL;
+	pp_data->drblength = 0;
+	pp_data->link_class = NULL;
+	pp_data->lclength = 0;
+}
+
+static void free_rule_bits(PP_data *pp_data)
+{
+	free(pp_data->linkage_rule_bits);
+	free(pp_data->domain_rule_bits);
+	free(pp_data->link_class);
+}
+
 /**
  * read rules from path and initialize the appropriate fields in
  * a postprocessor structure, a pointer to which is returned.
@@ -1118,6 +1201,10 @@ Postprocessor * post_process_new(pp_knowledge * kno)
 
 	pp->q_pruned_rules = false;
 
+	pp->link_class = NULL;
+	pp->lc_size = 0;
+	pp->lc_count = 0;
+
 	pp_data = &pp->pp_data;
 	pp_data->vlength = PP_INITLEN;
 	pp_data->visited = (bool*) malloc(pp_data->vlength * sizeof(bool));
@@ -1125,6 +1212,7 @@ Postprocessor * post_process_new(pp_knowledge * kno)
 
 	pp_data->links_to_ignore = NULL;
 	pp_new_domain_array(pp_data);
+	new_rule_bits(pp_data, kno);
 
 	pp_data->wowlen = PP_INITLEN;
 	pp_data->word_links = (List_o_links **) malloc(pp_data->wowlen * sizeof(List_o_links*));
@@ -1144,6 +1232,7 @@ void post_process_free(Postprocessor *pp)
 	pp_linkset_close(pp->set_of_links_in_an_active_rule);
 	free(pp->relevant_contains_one_rules);
 	free(pp->relevant_contains_none_rules);
+	free_link_classes(pp);
 	pp->knowledge = NULL;
 	free_pp_node(pp);
 
@@ -1153,10 +1242,92 @@ void post_process_free(Postprocessor *pp)
 	free(pp_data->visited);
 	free(pp_data->domain_array);
 	free(pp_data->word_links);
+	free_rule_bits(pp_data);
 
 	free(pp);
 }
 
+/**
+ * Return a postprocessor for post-processing other linkages of the same
+ * sentence in another thread. It has its own per-linkage state, but it
+ * shares the rules of pp and their pruning, which must have been done
+ * already (see post_process_prune_rules()). Use it only while pp exists.
+ */
+Postprocessor * post_process_new_helper(Postprocessor *pp)
+{
+	Postprocessor *hpp;
+	PP_data *pp_data;
+
+	hpp = (Postprocessor *) malloc (sizeof(Postprocessor));
+	*hpp = *pp;
+	hpp->string_set = string_set_create();
+	hpp->pp_node = NULL;
+	hpp->n_local_rules_firing = 0;
+	hpp->n_global_rules_firing = 0;
+
+	/* The rules must never be pruned again through the helper. */
+	hpp->q_pruned_rules = true;
+
+	/* The link classes of pp are not safe to share, since pp may add
+	 * to them concurrently. */
+	hpp->link_class = NULL;
+	hpp->lc_size = 0;
+	hpp->lc_count = 0;
+
+	pp_data = &hpp->pp_data;
+	memset(pp_data, 0, sizeof(PP_data));
+	pp_data->vlength = PP_INITLEN;
+	pp_data->visited = (bool*) malloc(pp_data->vlength * sizeof(bool));
+	memset(pp_data->visited, 0, pp_data->vlength * sizeof(bool));
+
+	pp_new_domain_array(pp_data);
+	new_rule_bits(pp_data, hpp->knowledge);
+
+	pp_data->wowlen = PP_INITLEN;
+	pp_data->word_links = (List_o_links **) malloc(pp_data->wowlen * sizeof(List_o_links*));
+	memset(pp_data->word_links, 0, pp_data->wowlen * sizeof(List_o_links *));
+
+	return hpp;
+}
+
+/**
+ * Free a postprocessor of post_process_new_helper(). The domain names
+ * it has set in linkages are freed too.
+ */
+void post_process_free_helper(Postprocessor *hpp)
+{
+	PP_data *pp_data;
+
+	if (hpp == NULL) return;
+	string_set_delete(hpp->string_set);
+	free_link_classes(hpp);
+	free_pp_node(hpp);
+
+	pp_data = &hpp->pp_data;
+	post_process_free_data(pp_data);
+	free(pp_data->visited);
+	free(pp_data->domain_array);
+	free(pp_data->word_links);
+	free_rule_bits(pp_data);
+
+	free(hpp);
+}
+
+/**
+ * For long sentences, we can save some time by pruning the rules
+ * which can't possibly be used during postprocessing the linkages
+ * of this sentence. For short sentences, this is pointless.
+ * This is done only once, on the first linkage to be post-processed.
+ */
+void post_process_prune_rules(Postprocessor *pp, bool is_long)
+{
+	if (is_long && pp->q_pruned_rules == false)
+	{
+		prune_irrelevant_rules(pp);
+	}
+	pp->q_pruned_rules = true;
+}
+
 /**
  * During a first pass (prior to actual post-processing of the linkages
  * of a sentence), call this once for every generated linkage. Here we
@@ -1267,14 +1438,7 @@ PP_node *do_post_process(Postprocessor *pp, Linkage sublinkage, bool is_long)
 	 * it out after every call, without relying on the user to do so. */
 	clear_pp_node(pp);
 
-	/* For long sentences, we can save some time by pruning the rules
-	 * which can't possibly be used during postprocessing the linkages
-	 * of this sentence. For short sentences, this is pointless. */
-	if (is_long && pp->q_pruned_rules == false)
-	{
-		prune_irrelevant_rules(pp);
-	}
-	pp->q_pruned_rules = true;
+	post_process_prune_rules(pp, is_long);
 
 	switch (internal_process(pp, sublinkage, &msg))
 	{
@@ -33,6 +33,9 @@ void pp_free_domain_array(PP_data *);
 
 Postprocessor * post_process_new(pp_knowledge *);
 void post_process_free(Postprocessor *);
+Postprocessor * post_process_new_helper(Postprocessor *);
+void post_process_free_helper(Postprocessor *);
+void post_process_prune_rules(Postprocessor *, bool);
 
 void     post_process_free_data(PP_data * ppd);
 void     post_process_scan_linkage(Postprocessor *, Linkage);
@@ -22,6 +22,7 @@
 #include "pp_knowledge.h"
 #include "pp_lexer.h"
 #include "pp_linkset.h"
+#include "post-process.h"
 #include "string-set.h"
 
 #define D_PPK 10                       /* verbosity level for this file */
@@ -381,8 +382,191 @@ static void free_rules(pp_knowledge *k)
   xfree((void*)k->contains_none_rules,     rs*(1+k->n_contains_none_rules));
 }
 
+/**************** compiling the symbols of the rules *****************/
+
+/**
+ * Hash the upper-case part of a link name or symbol. Since this part
+ * must be identical for a symbol to match a link name (see
+ * post_process_match()), the only candidate symbols for a link name
+ * are the ones in its bucket.
+ */
+static unsigned int symbol_hash(const char *str)
+{
+  unsigned int hashval = 37;
+  for (; isupper((int)*str); str++)
+    hashval = *str + 31*hashval;
+  return hashval;
+}
+
+static size_t symbol_index(pp_knowledge *k, const char *str)
+{
+  size_t h = symbol_hash(str) & (k->symbol_table_size - 1);
+  int i;
+  pp_symbol *sym;
+
+  for (i = k->symbol_table[h]; i != -1; i = k->symbol[i].next)
+    if (0 == strcmp(k->symbol[i].str, str)) return i;
+
+  assert(k->n_symbols < k->symbol_size, "Too many symbols");
+  sym = &k->symbol[k->n_symbols];
+  sym->str = str;
+  sym->flags = 0;
+  sym->starting_link = -1;
+  sym->next = k->symbol_table[h];
+  k->symbol_table[h] = k->n_symbols;
+  return k->n_symbols++;
+}
+
+static size_t linkset_size(pp_linkset *ls)
+{
+  return (ls == NULL) ? 0 : ls->population;
+}
+
+static void add_linkset_symbols(pp_knowledge *k, pp_linkset *ls,
+                                unsigned int flag)
+{
+  unsigned int i;
+  pp_linkset_node *p;
+  if (ls == NULL) return;
+  for (i=0; i<ls->hash_table_size; i++)
+    for (p=ls->hash_table[i]; p!=NULL; p=p->next)
+      k->symbol[symbol_index(k, p->str)].flags |= flag;
+}
+
+static void compile_contains_rules(pp_knowledge *k, pp_rule *rules,
+                                   size_t first_word, size_t nwords)
+{
+  size_t r, i;
+  for (r=0; rules[r].msg!=0; r++)
+  {
+    pp_rule *rule = &rules[r];
+    pp_symbol *sym;
+
+    rule->selector_word = first_word + PP_BITS_WORD(r);
+    rule->link_array_word = first_word + nwords + PP_BITS_WORD(r);
+    rule->bit = PP_BIT(r);
+
+    sym = &k->symbol[symbol_index(k, rule->selector)];
+    sym->rule_bits[rule->selector_word] |= rule->bit;
+    for (i=0; rule->link_array[i]!=0; i++)
+    {
+      sym = &k->symbol[symbol_index(k, rule->link_array[i])];
+      sym->rule_bits[rule->link_array_word] |= rule->bit;
+    }
+  }
+}
+
+/**
+ * Collect all the link names of the knowledge file as symbols, and
+ * record in each one the link sets and the rules it belongs to. Then
+ * a link name can be classified with only the few symbols which have
+ * its upper-case part (see pp_knowledge_classify()).
+ */
+static void compile_symbols(pp_knowledge *k)
+{
+  size_t r, i;
+  size_t co_words = PP_BITS_WORD(k->n_contains_one_rules) + 1;
+  size_t cn_words = PP_BITS_WORD(k->n_contains_none_rules) + 1;
+
+  /* An upper bound of the number of symbols */
+  k->symbol_size = k->nStartingLinks +
+    linkset_size(k->ignore_these_links) +
+    linkset_size(k->domain_starter_links) +
+    linkset_size(k->urfl_domain_starter_links) +
+    linkset_size(k->urfl_only_domain_starter_links) +
+    linkset_size(k->left_domain_starter_links) +
+    linkset_size(k->domain_contains_links) +
+    linkset_size(k->restricted_links);
+  for (r=0; r<k->n_contains_one_rules; r++)
+    k->symbol_size += 1 + k->contains_one_rules[r].link_set_size;
+  for (r=0; r<k->n_contains_none_rules; r++)
+    k->symbol_size += 1 + k->contains_none_rules[r].link_set_size;
+  if (0 == k->symbol_size) k->symbol_size = 1;
+
+  k->symbol = (pp_symbol *) xalloc(k->symbol_size * sizeof(pp_symbol));
+  k->rule_words = 2*co_words + 2*cn_words;
+  k->symbol[0].rule_bits = (pp_bits *)
+    xalloc(k->symbol_size * k->rule_words * sizeof(pp_bits));
+  memset(k->symbol[0].rule_bits, 0,
+         k->symbol_size * k->rule_words * sizeof(pp_bits));
+  for (i=1; i<k->symbol_size; i++)
+    k->symbol[i].rule_bits = k->symbol[0].rule_bits + i * k->rule_words;
+
+  for (k->symbol_table_size=1; k->symbol_table_size < 2*k->symbol_size;
+       k->symbol_table_size *= 2)
+    ;
+  k->symbol_table = (int *) xalloc(k->symbol_table_size * sizeof(int));
+  memset(k->symbol_table, -1, k->symbol_table_size * sizeof(int));
+
+  for (i=0; i<k->nStartingLinks; i++)
+  {
+    pp_symbol *sym = &k->symbol[symbol_index(k,
+                     k->starting_link_lookup_table[i].starting_link)];
+    if (-1 == sym->starting_link) sym->starting_link = i;
+  }
+
+  add_linkset_symbols(k, k->ignore_these_links, PP_IGNORE);
+  add_linkset_symbols(k, k->domain_starter_links, PP_DOMAIN_STARTER);
+  add_linkset_symbols(k, k->urfl_domain_starter_links, PP_URFL_DOMAIN_STARTER);
+  add_linkset_symbols(k, k->urfl_only_domain_starter_links,
+                      PP_URFL_ONLY_DOMAIN_STARTER);
+  add_linkset_symbols(k, k->left_domain_starter_links, PP_LEFT_DOMAIN_STARTER);
+  add_linkset_symbols(k, k->domain_contains_links, PP_DOMAIN_CONTAINS);
+  add_linkset_symbols(k, k->restricted_links, PP_RESTRICTED);
+
+  compile_contains_rules(k, k->contains_one_rules, 0, co_words);
+  compile_contains_rules(k, k->contains_none_rules, 2*co_words, cn_words);
+}
+
+static void free_symbols(pp_knowledge *k)
+{
+  if (NULL == k->symbol) return;
+  xfree((void*)k->symbol[0].rule_bits,
+        k->symbol_size * k->rule_words * sizeof(pp_bits));
+  xfree((void*)k->symbol, k->symbol_size * sizeof(pp_symbol));
+  xfree((void*)k->symbol_table, k->symbol_table_size * sizeof(int));
+}
+
 /********************* exported functions ***************************/
 
+/**
+ * Fill in lc with what the rules say about the link name, i.e. the
+ * union of all the symbols which match it. lc->rule_bits must be
+ * zeroed, with k->rule_words words.
+ */
+void pp_knowledge_classify(const pp_knowledge *k, const char *name,
+                           pp_link_class *lc)
+{
+  const char *t = name;
+  size_t w;
+  int i;
+  int starting_link = -1;
+
+  lc->name = name;
+  lc->flags = 0;
+  lc->domain = -1;
+  if (NULL == name) return;
+
+  if (islower((int)*t)) t++; /* Skip head-dependent indicator */
+  i = k->symbol_table[symbol_hash(t) & (k->symbol_table_size - 1)];
+  for (; i != -1; i = k->symbol[i].next)
+  {
+    const pp_symbol *sym = &k->symbol[i];
+    if (!post_process_match(sym->str, name)) continue;
+
+    lc->flags |= sym->flags;
+    for (w = 0; w < k->rule_words; w++)
+      lc->rule_bits[w] |= sym->rule_bits[w];
+    if ((sym->starting_link != -1) &&
+        ((starting_link == -1) || (sym->starting_link < starting_link)))
+      starting_link = sym->starting_link;
+  }
+
+  /* Like a lookup in the starting link table: the first match wins. */
+  if (starting_link != -1)
+    lc->domain = k->starting_link_lookup_table[starting_link].domain;
+}
+
 pp_knowledge *pp_knowledge_open(const char *path)
 {
   /* read knowledge from disk into pp_knowledge */
@@ -404,6 +588,7 @@ pp_knowledge *pp_knowledge_open(const char *path)
   if (!read_link_sets(k)) goto failure;
   if (!read_rules(k)) goto failure;
   initialize_set_of_links_starting_bounded_domain(k);
+  compile_symbols(k);
   return k;
 
 failure:
@@ -420,6 +605,7 @@ void pp_knowledge_close(pp_knowledge *k)
         ((1+k->nStartingLinks)*sizeof(StartingLinkAndDomain)));
   free_link_sets(k);
   free_rules(k);
+  free_symbols(k);
   pp_linkset_close(k->set_of_links_starting_bounded_domain);
   string_set_delete(k->string_set);
   if (NULL != k->lt) pp_lexer_close(k->lt);
@@ -14,3 +14,5 @@
 
 pp_knowledge *pp_knowledge_open(const char *path);
 void pp_knowledge_close(pp_knowledge *knowledge);
+void pp_knowledge_classify(const pp_knowledge *, const char *,
+                           pp_link_class *);
@@ -12,6 +12,7 @@
 
 #include "api-structures.h"
 #include "build-disjuncts.h"
+#include "connector-enum.h"
 #include "count.h"
 #include "disjunct-utils.h"
 #include "externs.h"
@@ -105,13 +106,8 @@ static void setup_connectors(Sentence sent)
 		for (d=sent->word[w].d; d!=NULL; d=xd)
 		{
 			xd = d->next;
-			if ((set_dist_fields(d->left, w, -1) < 0) ||
-			    (set_dist_fields(d->right, w, 1) >= (int) sent->length))
-			{
-				d->next = NULL;
-				free_disjuncts(d);
-			}
-			else
+			if ((set_dist_fields(d->left, w, -1) >= 0) &&
+			    (set_dist_fields(d->right, w, 1) < (int) sent->length))
 			{
 				d->next = head;
 				head = d;
@@ -121,6 +117,75 @@ static void setup_connectors(Sentence sent)
 	}
 }
 
+/**
+ * A snapshot of the disjunct lists of the sentence words, taken after
+ * prepare_to_parse(). Pruning only unlinks disjuncts (which remain in
+ * the sentence pools) and lowers the nearest_word of their connectors,
+ * so the lists can be restored by relinking the saved disjuncts and
+ * recomputing these fields, instead of copying all the disjuncts in
+ * advance.
+ */
+struct Disjuncts_snapshot_s
+{
+	Disjunct **dis;        /* The disjuncts of all the words, in order */
+	size_t *word_start;    /* Per word index into dis[] */
+};
+
+Disjuncts_snapshot * disjuncts_snapshot_save(Sentence sent)
+{
+	Disjuncts_snapshot *ds = xalloc(sizeof(Disjuncts_snapshot));
+	size_t num_dis = 0;
+
+	ds->word_start = xalloc((sent->length + 1) * sizeof(size_t));
+	for (size_t w = 0; w < sent->length; w++)
+	{
+		ds->word_start[w] = num_dis;
+		num_dis += count_disjuncts(sent->word[w].d);
+	}
+	ds->word_start[sent->length] = num_dis;
+
+	ds->dis = xalloc(num_dis * sizeof(Disjunct *));
+	Disjunct **dp = ds->dis;
+	for (size_t w = 0; w < sent->length; w++)
+	{
+		for (Disjunct *d = sent->word[w].d; d != NULL; d = d->next)
+			*dp++ = d;
+	}
+
+	return ds;
+}
+
+/**
+ * Restore the disjunct lists to their state when the snapshot was taken.
+ */
+void disjuncts_snapshot_restore(Sentence sent, Disjuncts_snapshot *ds)
+{
+	for (size_t w = 0; w < sent->length; w++)
+	{
+		Disjunct *head = NULL;
+
+		for (size_t i = ds->word_start[w+1]; i > ds->word_start[w]; i--)
+		{
+			Disjunct *d = ds->dis[i-1];
+
+			set_dist_fields(d->left, w, -1);
+			set_dist_fields(d->right, w, 1);
+			d->next = head;
+			head = d;
+		}
+		sent->word[w].d = head;
+	}
+}
+
+void disjuncts_snapshot_delete(Sentence sent, Disjuncts_snapshot *ds)
+{
+	if (NULL == ds) return;
+
+	xfree(ds->dis, ds->word_start[sent->length] * sizeof(Disjunct *));
+	xfree(ds->word_start, (sent->length + 1) * sizeof(size_t));
+	xfree(ds, sizeof(Disjuncts_snapshot));
+}
+
 /**
  * Record the wordgraph word in each of its connectors.
  * It is used for checking alternatives consistency.
@@ -137,6 +202,26 @@ static void gword_record_in_connector(Sentence sent)
 	}
 }
 
+/**
+ * Set the dictionary connector ID of each connector, so they can be
+ * matched using the precomputed match matrix (see connector-enum.c),
+ * and the disjuncts can be compared by their keys.
+ */
+static void set_connector_ids(Sentence sent)
+{
+	const Connector_enum *ce = sent->dict->connector_enum;
+	if (NULL == ce) return;
+
+	for (size_t w = 0; w < sent->length; w++) {
+		for (Disjunct *d = sent->word[w].d; d != NULL; d = d->next) {
+			for (Connector *c = d->right; NULL != c; c = c->next)
+				c->id = connector_enum_id(ce, c->string);
+			for (Connector *c = d->left; NULL != c; c = c->next)
+				c->id = connector_enum_id(ce, c->string);
+		}
+	}
+}
+
 /**
  * Assumes that the sentence expression lists have been generated.
  */
@@ -144,18 +229,20 @@ void prepare_to_parse(Sentence sent, Parse_Options opts)
 {
 	size_t i;
 
-	build_sentence_disjuncts(sent, opts->disjunct_cost);
+	build_sentence_disjuncts(sent, opts->disjunct_cost, opts->resources);
 	if (verbosity_level(5)) {
 		printf("After expanding expressions into disjuncts:");
 		print_disjunct_counts(sent);
 	}
 	print_time(opts, "Built disjuncts");
 
+	set_connector_ids(sent);
 	for (i=0; i<sent->length; i++) {
-		sent->word[i].d = eliminate_duplicate_disjuncts(sent->word[i].d);
+		sent->word[i].d = eliminate_duplicate_disjuncts(sent->word[i].d,
+		                                        sent->dict->connector_enum);
 
 		/* Some long Russian sentences can really blow up, here. */
-		if (resources_exhausted(opts->resources))
+		if (resources_exhausted_or_cancelled(opts->resources, sent))
 			return;
 	}
 	print_time(opts, "Eliminated duplicate disjuncts");
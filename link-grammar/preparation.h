@@ -15,5 +15,10 @@
 #define _PREPARATION_H
 #include "link-includes.h"
 
+typedef struct Disjuncts_snapshot_s Disjuncts_snapshot;
+
 void prepare_to_parse(Sentence, Parse_Options);
+Disjuncts_snapshot * disjuncts_snapshot_save(Sentence);
+void disjuncts_snapshot_restore(Sentence, Disjuncts_snapshot *);
+void disjuncts_snapshot_delete(Sentence, Disjuncts_snapshot *);
 #endif /* _PREPARATION_H */
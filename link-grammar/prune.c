@@ -11,7 +11,12 @@
 /*                                                                       */
 /*************************************************************************/
 
+#ifdef USE_PTHREADS
+#include <pthread.h>
+#endif /* USE_PTHREADS */
+
 #include "api-structures.h"
+#include "connector-enum.h"
 #include "count.h"
 #include "dict-api.h"  /* for print_expression when debugging */
 #include "disjunct-utils.h"
@@ -40,11 +45,41 @@ struct disjunct_dup_table_s
 /* Indicator that this connector cannot be used -- that its "obsolete".  */
 #define BAD_WORD (MAX_SENTENCE+1)
 
+typedef struct prune_dis_s Prune_dis;
+typedef struct prune_dep_s Prune_dep;
+
+/* A list of disjuncts that depend on a connector list of a disjunct. */
+struct prune_dep_s
+{
+	Prune_dep *next;
+	Prune_dis *pd;
+};
+
+/* The power pruning state of a disjunct. */
+struct prune_dis_s
+{
+	Disjunct *d;
+	Prune_dep *dep[2];   /* Disjuncts whose last update found a match on
+	                        [0] my left or [1] my right connectors */
+	bool dirty[2];       /* [0] the left or [1] the right connectors
+	                        need to be updated */
+	bool changed;        /* The last update changed a nearest_word */
+	bool deleted;
+};
+
+/* A match found by a disjunct update; see record_match(). */
+typedef struct
+{
+	Prune_dis *dependent;
+	Prune_dis *supporter;
+} Prune_dep_pair;
+
 typedef struct c_list_s C_list;
 struct c_list_s
 {
 	C_list * next;
 	Connector * c;
+	Prune_dis * pd;      /* The disjunct of c */
 	bool shallow;
 };
 
@@ -73,6 +108,10 @@ struct multiset_table_s
 	Cms * cms_table[CMS_SIZE];
 };
 
+#ifdef USE_PTHREADS
+typedef struct prune_threads_s prune_threads;
+#endif /* USE_PTHREADS */
+
 typedef struct prune_context_s prune_context;
 struct prune_context_s
 {
@@ -80,11 +119,32 @@ struct prune_context_s
 	int power_cost;
 	int N_changed;   /* counts the number of changes
 						   of c->nearest_word fields in a pass */
+	size_t N_deleted; /* disjuncts deleted in a pass */
 	power_table *pt;
+	const Connector_enum *cenum;
 #ifdef ALT_DISJUNCT_CONSISTENCY
 	const Connector *first_connector; /* for alt disjunct consistency */
 #endif
 	Sentence sent;
+
+	/* The disjuncts of word w are pdis[word_start[w]..word_start[w+1]). */
+	Prune_dis *pdis;
+	size_t *word_start;
+	bool *reversed;          /* The word's disjunct list is to be reversed */
+	Prune_dis **work;        /* The disjuncts to update in the current word */
+	size_t work_size;
+	Pool_desc *dep_pool;     /* Prune_dep elements */
+
+	/* The matches found by the updates of the current word */
+	Prune_dis *cur_pd;       /* The disjunct being updated */
+	Prune_dep_pair *pairs;
+	size_t num_pairs;
+	size_t pairs_size;
+
+#ifdef USE_PTHREADS
+	int num_threads;        /* The threads option */
+	prune_threads *threads; /* Started for the first word with enough work */
+#endif /* USE_PTHREADS */
 };
 
 /*
@@ -595,7 +655,7 @@ static Connector * insert_connectors(connector_table *ct, Exp * e,
 	{
 		if (e->dir == dir)
 		{
-			Connector *dummy = connector_new();
+			Connector *dummy = connector_new(NULL);
 			dummy->string = e->u.string;
 			insert_connector(ct, dummy);
 			dummy->next = alloc_list;
@@ -732,6 +792,315 @@ DBG(printf("after purging: "); print_expression(x->exp); printf("\n"););
 	}
 }
 
+/* ===================================================================
+   Dictionary pre-pruning
+
+   Some connectors of a dictionary cannot be matched by any connector
+   of any word, so expression_prune() deletes them again in every
+   sentence. Instead, they are found once when the dictionary is
+   loaded, and the alternatives that use them are removed from the
+   dictionary expressions, so they are not even copied and expanded.
+
+   An expression is dead if it cannot yield any disjunct: a connector
+   if it cannot be matched, an AND if one of its operands is dead, and
+   an OR if all of its operands are dead. Only the connectors that can
+   be reached from a dictionary entry through expressions that are not
+   dead can be used. So finding dead expressions may leave more
+   connectors unmatched; this is repeated until nothing changes.
+
+   Dead operands are removed only from OR expressions that are not dead.
+   So a dictionary entry never gets an empty expression, and the
+   disjuncts of the remaining expressions are the same as before, except
+   for those that expression_prune() would delete anyway.
+
+   Dead expressions of dictionary entries, like <marker-entity>, are
+   markers that the tokenizer looks for in the word expressions (see
+   word_contains()). So the operands that contain them are kept.
+*/
+
+#define EXP_DEAD    1  /* Cannot yield any disjunct */
+#define EXP_REACHED 2  /* Reached in this round */
+#define EXP_DONE    4  /* Deadness computed in this round */
+#define EXP_ENTRY   8  /* The expression of a dictionary entry */
+#define EXP_MARKER 16  /* Contains a dead expression of an entry */
+#define EXP_MARKER_DONE 32
+
+/* The expressions are identified by their index in the sorted exp[]. */
+typedef struct
+{
+	Exp **exp;              /* All the dictionary expressions, by address */
+	uint8_t *state;         /* The EXP_* flags of each of them */
+	size_t num_exp;
+	/* The operands of exp[i] are operand[operand_start[i]..
+	 * operand_start[i+1]), in their order. */
+	size_t *operand_start;
+	size_t *operand;
+	size_t *entry;          /* The expressions of the dictionary entries */
+	size_t num_entry;
+	connector_table *ct[2]; /* The usable [0] '-' and [1] '+' connectors */
+	Connector *dummy_list;
+	const char *empty_connector;
+} dict_prune_context;
+
+static int exp_address_cmp(const void *a, const void *b)
+{
+	uintptr_t e1 = (uintptr_t) *(Exp * const *) a;
+	uintptr_t e2 = (uintptr_t) *(Exp * const *) b;
+
+	return (e1 < e2) ? -1 : (e1 > e2);
+}
+
+static size_t exp_index(dict_prune_context *dpc, Exp *e)
+{
+	Exp **ep = bsearch(&e, dpc->exp, dpc->num_exp, sizeof(Exp *),
+	                   exp_address_cmp);
+
+	assert(NULL != ep, "Expression not in the dictionary expression list");
+	return ep - dpc->exp;
+}
+
+static size_t count_entries(Dict_node *dn)
+{
+	if (NULL == dn) return 0;
+	return (NULL != dn->exp) + count_entries(dn->left) + count_entries(dn->right);
+}
+
+static void add_entries(dict_prune_context *dpc, Dict_node *dn)
+{
+	if (NULL == dn) return;
+	if (NULL != dn->exp)
+	{
+		size_t i = exp_index(dpc, dn->exp);
+		dpc->state[i] |= EXP_ENTRY;
+		dpc->entry[dpc->num_entry++] = i;
+	}
+	add_entries(dpc, dn->left);
+	add_entries(dpc, dn->right);
+}
+
+static void add_usable_connector(dict_prune_context *dpc,
+                                 const char *string, char dir)
+{
+	Connector *dummy = connector_new(NULL);
+
+	dummy->string = string;
+	insert_connector(dpc->ct['+' == dir], dummy);
+	dummy->next = dpc->dummy_list;
+	dpc->dummy_list = dummy;
+}
+
+/**
+ * Put into the usable connector tables the connectors that can be
+ * reached from exp[i] through expressions that are not known to be dead.
+ */
+static void reach_connectors(dict_prune_context *dpc, size_t i)
+{
+	if (dpc->state[i] & (EXP_DEAD|EXP_REACHED)) return;
+	dpc->state[i] |= EXP_REACHED;
+
+	Exp *e = dpc->exp[i];
+	if (CONNECTOR_type == e->type)
+	{
+		add_usable_connector(dpc, e->u.string, e->dir);
+		return;
+	}
+	for (size_t o = dpc->operand_start[i]; o < dpc->operand_start[i+1]; o++)
+		reach_connectors(dpc, dpc->operand[o]);
+}
+
+static bool exp_is_dead(dict_prune_context *dpc, size_t i)
+{
+	uint8_t *state = &dpc->state[i];
+	Exp *e = dpc->exp[i];
+	bool dead;
+
+	if (*state & EXP_DONE) return (*state & EXP_DEAD);
+
+	if (CONNECTOR_type == e->type)
+	{
+		Connector dummy;
+		init_connector(&dummy);
+		dummy.string = e->u.string;
+		dead = !matches_S(dpc->ct['-' == e->dir], &dummy);
+	}
+	else
+	{
+		/* An AND is dead if any operand is; an OR if all of them are. */
+		bool is_and = (AND_type == e->type);
+
+		dead = !is_and;
+		for (size_t o = dpc->operand_start[i]; o < dpc->operand_start[i+1]; o++)
+		{
+			if (exp_is_dead(dpc, dpc->operand[o]) == is_and)
+			{
+				dead = is_and;
+				break;
+			}
+		}
+	}
+
+	*state = (*state & ~EXP_DEAD) | EXP_DONE | (dead ? EXP_DEAD : 0);
+	return dead;
+}
+
+/**
+ * Return true iff exp[i] contains a dead expression of a dictionary
+ * entry.
+ */
+static bool exp_has_marker(dict_prune_context *dpc, size_t i)
+{
+	uint8_t *state = &dpc->state[i];
+
+	if (*state & EXP_MARKER_DONE) return (*state & EXP_MARKER);
+	*state |= EXP_MARKER_DONE;
+
+	bool marker = ((*state & (EXP_ENTRY|EXP_DEAD)) == (EXP_ENTRY|EXP_DEAD));
+	for (size_t o = dpc->operand_start[i];
+	     !marker && (o < dpc->operand_start[i+1]); o++)
+	{
+		marker = exp_has_marker(dpc, dpc->operand[o]);
+	}
+
+	if (marker) *state |= EXP_MARKER;
+	return marker;
+}
+
+/**
+ * Find the dead expressions. Return their number.
+ */
+static size_t find_dead_expressions(dict_prune_context *dpc)
+{
+	size_t num_dead = 0;
+
+	while (true)
+	{
+		for (size_t i = 0; i < dpc->num_exp; i++)
+			dpc->state[i] &= ~(EXP_REACHED|EXP_DONE);
+		zero_connector_table(dpc->ct[0]);
+		zero_connector_table(dpc->ct[1]);
+
+		for (size_t n = 0; n < dpc->num_entry; n++)
+			reach_connectors(dpc, dpc->entry[n]);
+		/* Each sentence adds ZZZ+ connectors; see add_empty_word(). */
+		add_usable_connector(dpc, dpc->empty_connector, '+');
+
+		size_t prev_num_dead = num_dead;
+		num_dead = 0;
+		for (size_t i = 0; i < dpc->num_exp; i++)
+			if (exp_is_dead(dpc, i)) num_dead++;
+
+		free_connectors(dpc->dummy_list);
+		dpc->dummy_list = NULL;
+
+		lgdebug(+D_PRUNE, "%zu dead expressions\n", num_dead);
+		/* The dead expressions only accumulate. */
+		if (num_dead == prev_num_dead) break;
+	}
+
+	return num_dead;
+}
+
+/**
+ * Remove the dead operands of the OR expressions that are not dead.
+ * Return the number of removed operands.
+ */
+static size_t remove_dead_operands(dict_prune_context *dpc)
+{
+	size_t num_removed = 0;
+
+	for (size_t i = 0; i < dpc->num_exp; i++)
+	{
+		Exp *e = dpc->exp[i];
+
+		if ((OR_type != e->type) || (dpc->state[i] & EXP_DEAD)) continue;
+
+		/* The E_list elements are in the order of the operands. */
+		E_list **lp = &e->u.l;
+		for (size_t o = dpc->operand_start[i]; o < dpc->operand_start[i+1]; o++)
+		{
+			E_list *l = *lp;
+			size_t op = dpc->operand[o];
+
+			if ((dpc->state[op] & EXP_DEAD) && !exp_has_marker(dpc, op))
+			{
+				*lp = l->next;
+				xfree(l, sizeof(E_list));
+				num_removed++;
+			}
+			else
+			{
+				lp = &l->next;
+			}
+		}
+	}
+
+	return num_removed;
+}
+
+/**
+ * Remove from the dictionary expressions the alternatives that can
+ * never be used in any sentence. See above.
+ */
+void dictionary_prune(Dictionary dict)
+{
+	dict_prune_context dpc;
+	size_t num_removed = 0;
+	size_t i, num_operands;
+
+	dpc.num_exp = 0;
+	num_operands = 0;
+	for (Exp *e = dict->exp_list.exp_list; NULL != e; e = e->next)
+	{
+		dpc.num_exp++;
+		if (CONNECTOR_type == e->type) continue;
+		for (E_list *l = e->u.l; NULL != l; l = l->next) num_operands++;
+	}
+	if (0 == dpc.num_exp) return;
+
+	dpc.exp = xalloc(dpc.num_exp * sizeof(Exp *));
+	i = 0;
+	for (Exp *e = dict->exp_list.exp_list; NULL != e; e = e->next)
+		dpc.exp[i++] = e;
+	qsort(dpc.exp, dpc.num_exp, sizeof(Exp *), exp_address_cmp);
+
+	dpc.state = xalloc(dpc.num_exp * sizeof(uint8_t));
+	memset(dpc.state, 0, dpc.num_exp * sizeof(uint8_t));
+
+	dpc.operand_start = xalloc((dpc.num_exp + 1) * sizeof(size_t));
+	dpc.operand = xalloc(num_operands * sizeof(size_t));
+	num_operands = 0;
+	for (i = 0; i < dpc.num_exp; i++)
+	{
+		Exp *e = dpc.exp[i];
+
+		dpc.operand_start[i] = num_operands;
+		if (CONNECTOR_type == e->type) continue;
+		for (E_list *l = e->u.l; NULL != l; l = l->next)
+			dpc.operand[num_operands++] = exp_index(&dpc, l->e);
+	}
+	dpc.operand_start[dpc.num_exp] = num_operands;
+
+	dpc.num_entry = 0;
+	dpc.entry = xalloc(count_entries(dict->root) * sizeof(size_t));
+	add_entries(&dpc, dict->root);
+
+	dpc.ct[0] = xalloc(2 * CONTABSZ * sizeof(connector_table));
+	dpc.ct[1] = dpc.ct[0] + CONTABSZ;
+	dpc.dummy_list = NULL;
+	dpc.empty_connector = string_set_add(EMPTY_CONNECTOR, dict->string_set);
+
+	if (0 != find_dead_expressions(&dpc))
+		num_removed = remove_dead_operands(&dpc);
+	lgdebug(+D_PRUNE, "Removed %zu dead alternatives\n", num_removed);
+
+	xfree(dpc.exp, dpc.num_exp * sizeof(Exp *));
+	xfree(dpc.state, dpc.num_exp * sizeof(uint8_t));
+	xfree(dpc.operand_start, (dpc.num_exp + 1) * sizeof(size_t));
+	xfree(dpc.operand, num_operands * sizeof(size_t));
+	xfree(dpc.entry, dpc.num_entry * sizeof(size_t));
+	xfree(dpc.ct[0], 2 * CONTABSZ * sizeof(connector_table));
+}
+
 
 
 /*
@@ -847,7 +1216,8 @@ static void power_table_delete(power_table *pt)
  * The disjunct d (whose left or right pointer points to c) is put
  * into the appropriate hash table
  */
-static void put_into_power_table(unsigned int size, C_list ** t, Connector * c, bool shal)
+static void put_into_power_table(unsigned int size, C_list ** t,
+                                 Connector * c, Prune_dis * pd, bool shal)
 {
 	unsigned int h;
 	C_list * m;
@@ -856,19 +1226,21 @@ static void put_into_power_table(unsigned int size, C_list ** t, Connector * c,
 	m->next = t[h];
 	t[h] = m;
 	m->c = c;
+	m->pd = pd;
 	m->shallow = shal;
 }
 
 /**
  * Allocates and builds the initial power hash tables
  */
-static power_table * power_table_new(Sentence sent)
+static power_table * power_table_new(prune_context *pc)
 {
+	Sentence sent = pc->sent;
 	power_table *pt;
-	size_t w, len;
+	size_t w, len, k;
 	unsigned int i, size;
 	C_list ** t;
-	Disjunct * d;
+	Prune_dis * pd;
 	Connector * c;
 
 	pt = (power_table *) xalloc (sizeof(power_table));
@@ -903,12 +1275,13 @@ static power_table * power_table_new(Sentence sent)
 		t = pt->l_table[w] = (C_list **) xalloc(size * sizeof(C_list *));
 		for (i=0; i<size; i++) t[i] = NULL;
 
-		for (d=sent->word[w].d; d!=NULL; d=d->next) {
-			c = d->left;
+		for (k = pc->word_start[w]; k < pc->word_start[w+1]; k++) {
+			pd = &pc->pdis[k];
+			c = pd->d->left;
 			if (c != NULL) {
-				put_into_power_table(size, t, c, true);
+				put_into_power_table(size, t, c, pd, true);
 				for (c=c->next; c!=NULL; c=c->next) {
-					put_into_power_table(size, t, c, false);
+					put_into_power_table(size, t, c, pd, false);
 				}
 			}
 		}
@@ -920,12 +1293,13 @@ static power_table * power_table_new(Sentence sent)
 		t = pt->r_table[w] = (C_list **) xalloc(size * sizeof(C_list *));
 		for (i=0; i<size; i++) t[i] = NULL;
 
-		for (d=sent->word[w].d; d!=NULL; d=d->next) {
-			c = d->right;
+		for (k = pc->word_start[w]; k < pc->word_start[w+1]; k++) {
+			pd = &pc->pdis[k];
+			c = pd->d->right;
 			if (c != NULL) {
-				put_into_power_table(size, t, c, true);
+				put_into_power_table(size, t, c, pd, true);
 				for (c=c->next; c!=NULL; c=c->next){
-					put_into_power_table(size, t, c, false);
+					put_into_power_table(size, t, c, pd, false);
 				}
 			}
 		}
@@ -1106,14 +1480,15 @@ static bool possible_connection(prune_context *pc,
 	if (!alt_consistency(pc, lc, rc, lword, rword, lr)) return false;
 #endif
 
-	return easy_match(lc->string, rc->string);
+	return connectors_match(pc->cenum, lc, rc);
 }
 
 /**
- * This returns TRUE if the right table of word w contains
- * a connector that can match to c.  shallow tells if c is shallow.
+ * This returns the entry of the right table of word w of a connector
+ * that can match to c, or NULL if there is none. shallow tells if c
+ * is shallow.
  */
-static bool
+static C_list *
 right_table_search(prune_context *pc, int w, Connector *c,
                    bool shallow, int word_c)
 {
@@ -1126,16 +1501,17 @@ right_table_search(prune_context *pc, int w, Connector *c,
 	for (cl = pt->r_table[w][h]; cl != NULL; cl = cl->next)
 	{
 		if (possible_connection(pc, cl->c, c, cl->shallow, shallow, w, word_c, true))
-			return true;
+			return cl;
 	}
-	return false;
+	return NULL;
 }
 
 /**
- * This returns TRUE if the right table of word w contains
- * a connector that can match to c.  shallows tells if c is shallow
+ * This returns the entry of the left table of word w of a connector
+ * that can match to c, or NULL if there is none. shallow tells if c
+ * is shallow.
  */
-static bool
+static C_list *
 left_table_search(prune_context *pc, int w, Connector *c,
                   bool shallow, int word_c)
 {
@@ -1148,9 +1524,33 @@ left_table_search(prune_context *pc, int w, Connector *c,
 	for (cl = pt->l_table[w][h]; cl != NULL; cl = cl->next)
 	{
 		if (possible_connection(pc, c, cl->c, shallow, cl->shallow, word_c, w, false))
-			return true;
+			return cl;
 	}
-	return false;
+	return NULL;
+}
+
+/**
+ * Record that the disjunct being updated has found a match on a
+ * connector of the disjunct supporter. The update of the disjunct will
+ * find the same matches, so change nothing, as long as the supporter
+ * does not change.
+ */
+static void record_match(prune_context *pc, Prune_dis *supporter)
+{
+	if (pc->num_pairs == pc->pairs_size)
+	{
+		size_t new_size = (0 == pc->pairs_size) ? 256 : 2 * pc->pairs_size;
+		Prune_dep_pair *pairs = xalloc(new_size * sizeof(Prune_dep_pair));
+
+		memcpy(pairs, pc->pairs, pc->num_pairs * sizeof(Prune_dep_pair));
+		xfree(pc->pairs, pc->pairs_size * sizeof(Prune_dep_pair));
+		pc->pairs = pairs;
+		pc->pairs_size = new_size;
+	}
+
+	pc->pairs[pc->num_pairs].dependent = pc->cur_pd;
+	pc->pairs[pc->num_pairs].supporter = supporter;
+	pc->num_pairs++;
 }
 
 /**
@@ -1167,6 +1567,7 @@ left_connector_list_update(prune_context *pc, Connector *c,
 {
 	int n, lb;
 	bool foundmatch;
+	C_list *cl;
 
 	if (c == NULL) return w;
 	n = left_connector_list_update(pc, c->next, w, false) - 1;
@@ -1181,8 +1582,10 @@ left_connector_list_update(prune_context *pc, Connector *c,
 	for (; n >= lb ; n--)
 	{
 		pc->power_cost++;
-		if (right_table_search(pc, n, c, shallow, w))
+		cl = right_table_search(pc, n, c, shallow, w);
+		if (NULL != cl)
 		{
+			record_match(pc, cl->pd);
 			foundmatch = true;
 			break;
 		}
@@ -1209,6 +1612,7 @@ right_connector_list_update(prune_context *pc, Connector *c,
 {
 	size_t n, ub;
 	bool foundmatch;
+	C_list *cl;
 	Sentence sent = pc->sent;
 
 	if (c == NULL) return w;
@@ -1224,8 +1628,10 @@ right_connector_list_update(prune_context *pc, Connector *c,
 	for (; n <= ub ; n++)
 	{
 		pc->power_cost++;
-		if (left_table_search(pc, n, c, shallow, w))
+		cl = left_table_search(pc, n, c, shallow, w);
+		if (NULL != cl)
 		{
+			record_match(pc, cl->pd);
 			foundmatch = true;
 			break;
 		}
@@ -1237,28 +1643,450 @@ right_connector_list_update(prune_context *pc, Connector *c,
 	return (foundmatch ? n : sent->length);
 }
 
+/**
+ * Update the nearest_word of the left connectors of the disjunct pd of
+ * word w. If they cannot all be matched, mark all the connectors of the
+ * disjunct as obsolete (BAD_WORD), and count it as deleted.
+ */
+static void left_disjunct_update(prune_context *pc, Prune_dis *pd, int w)
+{
+	Disjunct *d = pd->d;
+	int N_changed = pc->N_changed;
+	Connector *c;
+
+	pc->cur_pd = pd;
+#ifdef ALT_DISJUNCT_CONSISTENCY
+	pc->first_connector = d->left;
+#endif
+	if (left_connector_list_update(pc, d->left, w, true) < 0) {
+		for (c=d->left;  c != NULL; c = c->next) c->nearest_word = BAD_WORD;
+		for (c=d->right; c != NULL; c = c->next) c->nearest_word = BAD_WORD;
+		pd->deleted = true;
+		pc->N_deleted++;
+	}
+	pd->changed = (N_changed != pc->N_changed);
+}
+
+/**
+ * Update the nearest_word of the right connectors of the disjunct pd
+ * of word w. See left_disjunct_update().
+ */
+static void right_disjunct_update(prune_context *pc, Prune_dis *pd, int w)
+{
+	Disjunct *d = pd->d;
+	int N_changed = pc->N_changed;
+	Connector *c;
+
+	pc->cur_pd = pd;
+#ifdef ALT_DISJUNCT_CONSISTENCY
+	pc->first_connector = d->right;
+#endif
+	if (right_connector_list_update(pc, d->right, w, true) >= pc->sent->length) {
+		for (c=d->right; c != NULL; c = c->next) c->nearest_word = BAD_WORD;
+		for (c=d->left;  c != NULL; c = c->next) c->nearest_word = BAD_WORD;
+		pd->deleted = true;
+		pc->N_deleted++;
+	}
+	pd->changed = (N_changed != pc->N_changed);
+}
+
+/**
+ * Update the disjuncts pc->work[start..end) of word w.
+ * dir is -1 to update their left connectors, and 1 to update their
+ * right ones.
+ */
+static void update_work(prune_context *pc, size_t start, size_t end,
+                        int w, int dir)
+{
+	for (size_t i = start; i < end; i++)
+	{
+		if (dir < 0)
+			left_disjunct_update(pc, pc->work[i], w);
+		else
+			right_disjunct_update(pc, pc->work[i], w);
+	}
+}
+
+#ifdef USE_PTHREADS
+/*
+ * Multi-threaded power pruning.
+ *
+ * The passes must visit the words in order, since the update of a word
+ * uses the result of the updates of the words before it. But within a
+ * word, the update of each disjunct reads only the tables of the other
+ * words, and writes only its own connectors. So the disjuncts of a word
+ * with many of them are divided among the threads, in chunks. The
+ * result is exactly the same as that of a single thread.
+ *
+ * The threads are started only when the first such word is reached,
+ * and sentences without such a word don't start them at all.
+ */
+
+/* Words with fewer disjuncts to update are done by the main thread alone. */
+#define MIN_PARALLEL_DISJUNCTS 256
+#define PRUNE_CHUNK_SIZE 32
+
+struct prune_threads_s
+{
+	pthread_mutex_t lock;
+	pthread_cond_t work_ready;
+	pthread_cond_t work_done;
+	unsigned int generation;     /* Incremented for each new word */
+	int busy;                    /* Workers still updating this word */
+	bool quit;
+
+	/* The current word */
+	size_t num_work;
+	size_t next_work;            /* Next chunk start (atomic) */
+	int w;
+	int dir;                     /* -1: left connectors, 1: right ones */
+
+	int num_workers;
+	pthread_t *thread;
+	prune_context *wpc;          /* Per-worker contexts */
+};
+
+/**
+ * Update the disjuncts of the current word, a chunk at a time, until
+ * none is left.
+ */
+static void prune_word_chunks(prune_threads *pt, prune_context *pc)
+{
+	while (true)
+	{
+		size_t start = __atomic_fetch_add(&pt->next_work, PRUNE_CHUNK_SIZE,
+		                                  __ATOMIC_RELAXED);
+		if (start >= pt->num_work) break;
+		size_t end = MIN(start + PRUNE_CHUNK_SIZE, pt->num_work);
+
+		update_work(pc, start, end, pt->w, pt->dir);
+	}
+}
+
+static void *prune_worker(void *arg)
+{
+	prune_context *pc = arg;
+	prune_threads *pt = pc->threads;
+	unsigned int seen = 0;
+
+	pthread_mutex_lock(&pt->lock);
+	while (true)
+	{
+		while ((seen == pt->generation) && !pt->quit)
+			pthread_cond_wait(&pt->work_ready, &pt->lock);
+		if (pt->quit) break;
+		seen = pt->generation;
+		pthread_mutex_unlock(&pt->lock);
+
+		prune_word_chunks(pt, pc);
+
+		pthread_mutex_lock(&pt->lock);
+		if (0 == --pt->busy) pthread_cond_signal(&pt->work_done);
+	}
+	pthread_mutex_unlock(&pt->lock);
+
+	return NULL;
+}
+
+static prune_threads *prune_threads_new(prune_context *pc, int num_threads)
+{
+	prune_threads *pt = xalloc(sizeof(prune_threads));
+	memset(pt, 0, sizeof(prune_threads));
+
+	pthread_mutex_init(&pt->lock, NULL);
+	pthread_cond_init(&pt->work_ready, NULL);
+	pthread_cond_init(&pt->work_done, NULL);
+
+	pt->thread = xalloc((num_threads - 1) * sizeof(pthread_t));
+	pt->wpc = xalloc((num_threads - 1) * sizeof(prune_context));
+	for (int i = 0; i < num_threads - 1; i++)
+	{
+		pt->wpc[i] = *pc;
+		pt->wpc[i].power_cost = 0;
+		pt->wpc[i].N_changed = 0;
+		pt->wpc[i].N_deleted = 0;
+		pt->wpc[i].pairs = NULL;
+		pt->wpc[i].num_pairs = 0;
+		pt->wpc[i].pairs_size = 0;
+		pt->wpc[i].threads = pt;
+		if (0 != pthread_create(&pt->thread[i], NULL, prune_worker, &pt->wpc[i]))
+			break;
+		pt->num_workers++;
+	}
+
+	return pt;
+}
+
+static void prune_threads_delete(prune_threads *pt, int num_threads)
+{
+	pthread_mutex_lock(&pt->lock);
+	pt->quit = true;
+	pthread_cond_broadcast(&pt->work_ready);
+	pthread_mutex_unlock(&pt->lock);
+
+	for (int i = 0; i < pt->num_workers; i++)
+	{
+		pthread_join(pt->thread[i], NULL);
+		xfree(pt->wpc[i].pairs, pt->wpc[i].pairs_size * sizeof(Prune_dep_pair));
+	}
+
+	pthread_mutex_destroy(&pt->lock);
+	pthread_cond_destroy(&pt->work_ready);
+	pthread_cond_destroy(&pt->work_done);
+
+	xfree(pt->thread, (num_threads - 1) * sizeof(pthread_t));
+	xfree(pt->wpc, (num_threads - 1) * sizeof(prune_context));
+	xfree(pt, sizeof(prune_threads));
+}
+
+/**
+ * Update the num_work disjuncts in pc->work using all the threads.
+ * Return false if there are too few of them for that (and then
+ * nothing is done).
+ */
+static bool parallel_word_update(prune_context *pc, size_t num_work,
+                                 int w, int dir)
+{
+	prune_threads *pt = pc->threads;
+
+	if ((0 == pt->num_workers) || (num_work < MIN_PARALLEL_DISJUNCTS))
+		return false;
+
+	pt->num_work = num_work;
+	pt->next_work = 0;
+	pt->w = w;
+	pt->dir = dir;
+
+	pthread_mutex_lock(&pt->lock);
+	pt->busy = pt->num_workers;
+	pt->generation++;
+	pthread_cond_broadcast(&pt->work_ready);
+	pthread_mutex_unlock(&pt->lock);
+
+	prune_word_chunks(pt, pc);
+
+	pthread_mutex_lock(&pt->lock);
+	while (0 != pt->busy)
+		pthread_cond_wait(&pt->work_done, &pt->lock);
+	pthread_mutex_unlock(&pt->lock);
+
+	/* The workers are idle now; collect their statistics. */
+	for (int i = 0; i < pt->num_workers; i++)
+	{
+		prune_context *wpc = &pt->wpc[i];
+
+		pc->power_cost += wpc->power_cost;
+		pc->N_changed += wpc->N_changed;
+		pc->N_deleted += wpc->N_deleted;
+		wpc->power_cost = wpc->N_changed = 0;
+		wpc->N_deleted = 0;
+	}
+
+	return true;
+}
+#endif /* USE_PTHREADS */
+
+/**
+ * Mark the given dependent disjuncts, so their connectors of the given
+ * side (0: left, 1: right) get updated again.
+ */
+static void mark_dependents(Prune_dep *dep, int side)
+{
+	for (; NULL != dep; dep = dep->next)
+		dep->pd->dirty[side] = true;
+}
+
+/**
+ * Add the matches recorded by the disjunct updates in wpc as
+ * dependencies. side is the side of the updated connectors (0: left,
+ * 1: right); the matched connectors are on the other side.
+ */
+static void add_dependents(prune_context *pc, prune_context *wpc, int side)
+{
+	for (size_t i = 0; i < wpc->num_pairs; i++)
+	{
+		Prune_dis *dependent = wpc->pairs[i].dependent;
+		Prune_dep **head = &wpc->pairs[i].supporter->dep[1-side];
+
+		if ((NULL != *head) && (dependent == (*head)->pd)) continue;
+
+		Prune_dep *dep = pool_alloc(pc->dep_pool);
+		dep->pd = dependent;
+		dep->next = *head;
+		*head = dep;
+	}
+	wpc->num_pairs = 0;
+}
+
+/**
+ * Update the disjuncts of word w. dir is -1 to update their left
+ * connectors, and 1 to update their right ones.
+ *
+ * Only the disjuncts that are marked as dirty for this side are
+ * updated. The others would not change, because all the connectors on
+ * which their previous update has found matches are still there, and
+ * still have the same nearest_word. When a disjunct changes, all the
+ * disjuncts that have found a match on it are marked as dirty. So the
+ * cost of a pass is proportional to the amount of change in the
+ * previous one, and the result is the same as updating all of them.
+ */
+static void word_update(prune_context *pc, int w, int dir)
+{
+	int side = (dir < 0) ? 0 : 1;
+	size_t num_work = 0;
+
+	for (size_t i = pc->word_start[w]; i < pc->word_start[w+1]; i++)
+	{
+		Prune_dis *pd = &pc->pdis[i];
+
+		if (pd->deleted || !pd->dirty[side]) continue;
+		pd->dirty[side] = false;
+		if (NULL == ((dir < 0) ? pd->d->left : pd->d->right)) continue;
+		pc->work[num_work++] = pd;
+	}
+
+#ifdef USE_PTHREADS
+	if ((NULL == pc->threads) && (1 < pc->num_threads) &&
+	    (MIN_PARALLEL_DISJUNCTS <= num_work))
+		pc->threads = prune_threads_new(pc, pc->num_threads);
+
+	if ((NULL == pc->threads) || !parallel_word_update(pc, num_work, w, dir))
+#endif /* USE_PTHREADS */
+	{
+		update_work(pc, 0, num_work, w, dir);
+	}
+
+	for (size_t i = 0; i < num_work; i++)
+	{
+		Prune_dis *pd = pc->work[i];
+
+		if (pd->deleted)
+		{
+			mark_dependents(pd->dep[0], 1);
+			mark_dependents(pd->dep[1], 0);
+		}
+		else if (pd->changed)
+		{
+			mark_dependents(pd->dep[side], 1-side);
+		}
+	}
+
+	add_dependents(pc, pc, side);
+#ifdef USE_PTHREADS
+	if (NULL != pc->threads)
+	{
+		for (int i = 0; i < pc->threads->num_workers; i++)
+			add_dependents(pc, &pc->threads->wpc[i], side);
+	}
+#endif /* USE_PTHREADS */
+}
+
+/**
+ * Set up the power pruning state of the disjuncts, in the order of
+ * the disjunct list of each word. Initially they all need an update.
+ */
+static void prune_dis_new(prune_context *pc)
+{
+	Sentence sent = pc->sent;
+	size_t num_dis = 0, max_word_dis = 0;
+	Disjunct *d;
+
+	pc->word_start = xalloc((sent->length + 1) * sizeof(size_t));
+	for (size_t w = 0; w < sent->length; w++)
+	{
+		pc->word_start[w] = num_dis;
+		for (d = sent->word[w].d; d != NULL; d = d->next) num_dis++;
+		max_word_dis = MAX(max_word_dis, num_dis - pc->word_start[w]);
+	}
+	pc->word_start[sent->length] = num_dis;
+
+	pc->pdis = xalloc(num_dis * sizeof(Prune_dis));
+	Prune_dis *pd = pc->pdis;
+	for (size_t w = 0; w < sent->length; w++)
+	{
+		for (d = sent->word[w].d; d != NULL; d = d->next, pd++)
+		{
+			pd->d = d;
+			pd->dep[0] = pd->dep[1] = NULL;
+			pd->dirty[0] = pd->dirty[1] = true;
+			pd->changed = pd->deleted = false;
+		}
+	}
+
+	pc->work_size = max_word_dis;
+	pc->work = xalloc(pc->work_size * sizeof(Prune_dis *));
+	pc->reversed = xalloc(sent->length * sizeof(bool));
+	memset(pc->reversed, 0, sent->length * sizeof(bool));
+	pc->dep_pool = pool_new("Prune_dep", 4096, sizeof(Prune_dep));
+	pc->pairs = NULL;
+	pc->num_pairs = 0;
+	pc->pairs_size = 0;
+}
+
+/**
+ * Rebuild the disjunct lists of the words from the disjuncts that have
+ * not been deleted. The deleted ones are released with the sentence
+ * disjunct pool.
+ * The lists used to be rebuilt after each pass over a word, reversing
+ * them. This order is kept, since it determines the order of the
+ * linkages.
+ */
+static void prune_dis_delete(prune_context *pc)
+{
+	Sentence sent = pc->sent;
+	for (size_t w = 0; w < sent->length; w++)
+	{
+		Disjunct *nd = NULL;
+		size_t start = pc->word_start[w];
+		size_t end = pc->word_start[w+1];
+
+		for (size_t i = 0; i < end - start; i++)
+		{
+			/* Prepending in reverse order keeps the order. */
+			Prune_dis *pd = &pc->pdis[pc->reversed[w] ? start + i : end - 1 - i];
+
+			if (!pd->deleted) {
+				pd->d->next = nd;
+				nd = pd->d;
+			}
+		}
+		sent->word[w].d = nd;
+	}
+
+	xfree(pc->pdis, pc->word_start[sent->length] * sizeof(Prune_dis));
+	xfree(pc->word_start, (sent->length + 1) * sizeof(size_t));
+	xfree(pc->work, pc->work_size * sizeof(Prune_dis *));
+	xfree(pc->reversed, sent->length * sizeof(bool));
+	xfree(pc->pairs, pc->pairs_size * sizeof(Prune_dep_pair));
+	pool_delete(pc->dep_pool);
+}
+
 /** The return value is the number of disjuncts deleted */
 int power_prune(Sentence sent, Parse_Options opts)
 {
 	power_table *pt;
 	prune_context *pc;
-	Disjunct *d, *free_later, *dx, *nd;
-	Connector *c;
-	size_t N_deleted, total_deleted;
+	size_t total_deleted;
 	size_t w;
+	bool aborted = false;
 
 	pc = (prune_context *) xalloc (sizeof(prune_context));
 	pc->power_cost = 0;
 	pc->null_links = (opts->min_null_count > 0);
 	pc->N_changed = 1;  /* forces it always to make at least two passes */
+	pc->N_deleted = 0;
 
 	pc->sent = sent;
+	pc->cenum = sent->dict->connector_enum;
 
-	pt = power_table_new(sent);
+	prune_dis_new(pc);
+	pt = power_table_new(pc);
 	pc->pt = pt;
 
-	free_later = NULL;
-	N_deleted = 0;
+#ifdef USE_PTHREADS
+	pc->num_threads = opts->threads;
+	pc->threads = NULL;
+#endif /* USE_PTHREADS */
 
 	total_deleted = 0;
 
@@ -1266,81 +2094,50 @@ int power_prune(Sentence sent, Parse_Options opts)
 	{
 		/* left-to-right pass */
 		for (w = 0; w < sent->length; w++) {
-			for (d = sent->word[w].d; d != NULL; d = d->next) {
-				if (d->left == NULL) continue;
-#ifdef ALT_DISJUNCT_CONSISTENCY
-				pc->first_connector = d->left;
-#endif
-				if (left_connector_list_update(pc, d->left, w, true) < 0) {
-					for (c=d->left;  c != NULL; c = c->next) c->nearest_word = BAD_WORD;
-					for (c=d->right; c != NULL; c = c->next) c->nearest_word = BAD_WORD;
-					N_deleted++;
-					total_deleted++;
-				}
-			}
+			word_update(pc, w, -1);
 
 			clean_table(pt->r_table_size[w], pt->r_table[w]);
-			nd = NULL;
-			for (d = sent->word[w].d; d != NULL; d = dx) {
-				dx = d->next;
-				if ((d->left != NULL) && (d->left->nearest_word == BAD_WORD)) {
-					d->next = free_later;
-					free_later = d;
-				} else {
-					d->next = nd;
-					nd = d;
-				}
-			}
-			sent->word[w].d = nd;
+			pc->reversed[w] = !pc->reversed[w];
+
+			/* Pruning less is harmless; the parse is abandoned anyway. */
+			aborted = resources_exhausted_or_cancelled(opts->resources, sent);
+			if (aborted) break;
 		}
+		total_deleted += pc->N_deleted;
 		if (verbosity_level(D_PRUNE))
 		{
-			printf("l->r pass changed %d and deleted %zu\n", pc->N_changed, N_deleted);
+			printf("l->r pass changed %d and deleted %zu\n", pc->N_changed, pc->N_deleted);
 		}
 
-		if (pc->N_changed == 0) break;
+		if ((pc->N_changed == 0) || aborted) break;
 
-		pc->N_changed = N_deleted = 0;
+		pc->N_changed = pc->N_deleted = 0;
 		/* right-to-left pass */
 
 		for (w = sent->length-1; w != (size_t) -1; w--) {
-			for (d = sent->word[w].d; d != NULL; d = d->next) {
-				if (d->right == NULL) continue;
-#ifdef ALT_DISJUNCT_CONSISTENCY
-				pc->first_connector = d->right;
-#endif
-				if (right_connector_list_update(pc, d->right, w, true) >= sent->length) {
-					for (c=d->right; c != NULL; c = c->next) c->nearest_word = BAD_WORD;
-					for (c=d->left;  c != NULL; c = c->next) c->nearest_word = BAD_WORD;
-					N_deleted++;
-					total_deleted++;
-				}
-			}
+			word_update(pc, w, 1);
+
 			clean_table(pt->l_table_size[w], pt->l_table[w]);
-			nd = NULL;
-			for (d = sent->word[w].d; d != NULL; d = dx) {
-				dx = d->next;
-				if ((d->right != NULL) && (d->right->nearest_word == BAD_WORD)) {
-					d->next = free_later;
-					free_later = d;
-				} else {
-					d->next = nd;
-					nd = d;
-				}
-			}
-			sent->word[w].d = nd;
+			pc->reversed[w] = !pc->reversed[w];
+
+			aborted = resources_exhausted_or_cancelled(opts->resources, sent);
+			if (aborted) break;
 		}
+		total_deleted += pc->N_deleted;
 
 		if (verbosity_level(D_PRUNE))
 		{
 			printf("r->l pass changed %d and deleted %zu\n",
-				pc->N_changed, N_deleted);
+				pc->N_changed, pc->N_deleted);
 		}
 
-		if (pc->N_changed == 0) break;
-		pc->N_changed = N_deleted = 0;
+		if ((pc->N_changed == 0) || aborted) break;
+		pc->N_changed = pc->N_deleted = 0;
 	}
-	free_disjuncts(free_later);
+#ifdef USE_PTHREADS
+	if (NULL != pc->threads) prune_threads_delete(pc->threads, pc->num_threads);
+#endif /* USE_PTHREADS */
+	prune_dis_delete(pc);
 	power_table_delete(pt);
 	pt = NULL;
 	pc->pt = NULL;
@@ -1536,63 +2333,374 @@ static bool delete_from_cms_table(multiset_table *cmt, const char * str)
 	return false;
 }
 
+/* Criterion links are at most this long (including the terminator). */
+#define PP_NAME_SIZE 20
+
+/**
+ * Make the names that connector names must post_process_match in order
+ * to combine into the given criterion link (see above). Return their
+ * number.
+ */
+static size_t criterion_patterns(const char *criterion,
+                                 char pattern[PP_NAME_SIZE][PP_NAME_SIZE])
+{
+	const char * t;
+	char name[PP_NAME_SIZE], *s;
+	size_t n_subscripts;
+
+	strncpy(name, criterion, sizeof(name)-1);
+	name[sizeof(name)-1] = '\0';
+
+	s = name;
+	if (islower((int)*s)) s++; /* skip head-dependent indicator */
+	for (; isupper((int)*s); s++) {}
+	for (;*s != '\0'; s++) if (*s != '*') *s = '#';
+
+	s = name;
+	t = criterion;
+	if (islower((int)*s)) s++; /* skip head-dependent indicator */
+	if (islower((int)*t)) t++; /* skip head-dependent indicator */
+	for (; isupper((int) *s); s++, t++) {}
+
+	/* s and t remain in lockstep */
+	n_subscripts = 0;
+	for (;*s != '\0'; s++, t++) {
+		if (*s == '*') continue;
+		/* after the upper case part, and is not a * so must be a regular subscript */
+		*s = *t;
+		strcpy(pattern[n_subscripts++], name);
+		*s = '#';
+	}
+
+	if (n_subscripts == 0) {
+		/* now we handle the special case which occurs if there
+		   were 0 subscripts */
+		strcpy(pattern[n_subscripts++], name);
+	}
+
+	return n_subscripts;
+}
+
 static bool rule_satisfiable(multiset_table *cmt, pp_linkset *ls)
 {
 	unsigned int hashval;
-	const char * t;
-	char name[20], *s;
+	char pattern[PP_NAME_SIZE][PP_NAME_SIZE];
 	pp_linkset_node *p;
-	int bad, n_subscripts;
+	size_t i, n_patterns;
 
 	for (hashval = 0; hashval < ls->hash_table_size; hashval++)
 	{
 		for (p = ls->hash_table[hashval]; p!=NULL; p=p->next)
 		{
 			/* ok, we've got our hands on one of the criterion links */
-			strncpy(name, p->str, sizeof(name)-1);
-			/* could actually use the string in place because we change it back */
-			name[sizeof(name)-1] = '\0';
 			/* now we want to see if we can satisfy this criterion link */
 			/* with a collection of the links in the cms table */
-
-			s = name;
-			if (islower((int)*s)) s++; /* skip head-dependent indicator */
-			for (; isupper((int)*s); s++) {}
-			for (;*s != '\0'; s++) if (*s != '*') *s = '#';
-
-			s = name;
-			t = p->str;
-			if (islower((int)*s)) s++; /* skip head-dependent indicator */
-			if (islower((int)*t)) t++; /* skip head-dependent indicator */
-			for (; isupper((int) *s); s++, t++) {}
-
-			/* s and t remain in lockstep */
-			bad = 0;
-			n_subscripts = 0;
-			for (;*s != '\0' && bad==0; s++, t++) {
-				if (*s == '*') continue;
-				n_subscripts++;
-				/* after the upper case part, and is not a * so must be a regular subscript */
-				*s = *t;
-				if (!match_in_cms_table(cmt, name)) bad++;
-				*s = '#';
+			n_patterns = criterion_patterns(p->str, pattern);
+			for (i = 0; i < n_patterns; i++)
+			{
+				if (!match_in_cms_table(cmt, pattern[i])) break;
 			}
 
-			if (n_subscripts == 0) {
-				/* now we handle the special case which occurs if there
-				   were 0 subscripts */
-				if (!match_in_cms_table(cmt, name)) bad++;
-			}
+			/* now if all the patterns matched, this criterion link
+			   does the job to satisfy the needs of the trigger link */
+			if (i == n_patterns) return true;
+		}
+	}
+	return false;
+}
+
+/*
+   The contains_one rules are also compiled, once per dictionary, for
+   the dictionary connector IDs (see connector-enum.c):
+   - For each connector ID, the rules that it triggers.
+   - For each criterion link of each rule, the IDs of the connectors
+     that match each of its patterns.
+   Then pp_prune() only needs to note which connector IDs a sentence
+   has, in a bitset, and check the patterns of the rules against it.
+
+   Note that match_in_cms_table() does not check the connector counts,
+   so deleting disjuncts never makes a rule unsatisfiable. Hence the
+   first pass of pp_prune() finds all that there is to delete, and the
+   rules that are unsatisfiable are so for all the disjuncts.
+*/
+
+typedef struct
+{
+	uint16_t *id;              /* The IDs of the matching connectors */
+	unsigned int num_id;
+} pp_pattern;
 
-			/* now if bad==0 this criterion link does the job
-			   to satisfy the needs of the trigger link */
+typedef struct
+{
+	pp_pattern *pattern;       /* All of them must match */
+	unsigned int num_pattern;
+} pp_criterion;
+
+typedef struct
+{
+	pp_criterion *criterion;   /* One of them must be satisfied */
+	unsigned int num_criterion;
+} pp_compiled_rule;
 
-			if (bad == 0) return true;
+struct Pp_prune_index_s
+{
+	pp_knowledge *knowledge;   /* The rules are compiled from it */
+	size_t num_id;             /* Of the dictionary connector enumeration */
+
+	/* The indexes of the rules that connector ID i triggers, in rule
+	 * order, are trigger[trigger_start[i]..trigger_start[i+1]). */
+	unsigned int *trigger_start;
+	unsigned int *trigger;
+	size_t num_trigger;
+
+	pp_compiled_rule *rule;    /* Per contains_one rule */
+};
+
+/**
+ * Return the IDs of the connectors that match the pattern.
+ */
+static void compile_pattern(pp_pattern *pat, const Connector_enum *ce,
+                            const char *pattern)
+{
+	pat->num_id = 0;
+	for (size_t id = 1; id < ce->num_id; id++)
+		if (post_process_match(pattern, ce->string[id])) pat->num_id++;
+
+	pat->id = xalloc(pat->num_id * sizeof(uint16_t));
+	pat->num_id = 0;
+	for (size_t id = 1; id < ce->num_id; id++)
+		if (post_process_match(pattern, ce->string[id])) pat->id[pat->num_id++] = id;
+}
+
+static void compile_rule(pp_compiled_rule *cr, const Connector_enum *ce,
+                         pp_linkset *ls)
+{
+	char pattern[PP_NAME_SIZE][PP_NAME_SIZE];
+	unsigned int hashval;
+	pp_linkset_node *p;
+
+	cr->num_criterion = 0;
+	for (hashval = 0; hashval < ls->hash_table_size; hashval++)
+		for (p = ls->hash_table[hashval]; p != NULL; p = p->next)
+			cr->num_criterion++;
+
+	cr->criterion = xalloc(cr->num_criterion * sizeof(pp_criterion));
+	cr->num_criterion = 0;
+	for (hashval = 0; hashval < ls->hash_table_size; hashval++)
+	{
+		for (p = ls->hash_table[hashval]; p != NULL; p = p->next)
+		{
+			pp_criterion *crit = &cr->criterion[cr->num_criterion++];
+
+			crit->num_pattern = criterion_patterns(p->str, pattern);
+			crit->pattern = xalloc(crit->num_pattern * sizeof(pp_pattern));
+			for (size_t i = 0; i < crit->num_pattern; i++)
+				compile_pattern(&crit->pattern[i], ce, pattern[i]);
+		}
+	}
+}
+
+/**
+ * Compile the contains_one rules of the dictionary post-processing
+ * knowledge for its connector enumeration.
+ * Return NULL if the dictionary has no such rules or enumeration.
+ */
+Pp_prune_index *pp_prune_index_create(Dictionary dict)
+{
+	const Connector_enum *ce = dict->connector_enum;
+	pp_knowledge *knowledge = dict->base_knowledge;
+
+	if ((NULL == ce) || (NULL == knowledge)) return NULL;
+	if (0 == knowledge->n_contains_one_rules) return NULL;
+
+	Pp_prune_index *ppi = xalloc(sizeof(Pp_prune_index));
+	ppi->knowledge = knowledge;
+	ppi->num_id = ce->num_id;
+
+	/* The rules with a * in the selector are never triggered; see above. */
+	size_t n_rules = knowledge->n_contains_one_rules;
+	bool *triggers = xalloc(n_rules * sizeof(bool));
+
+	ppi->trigger_start = xalloc((ce->num_id + 1) * sizeof(unsigned int));
+	ppi->num_trigger = 0;
+	ppi->trigger_start[0] = 0;
+	for (size_t id = 1; id < ce->num_id; id++)
+	{
+		ppi->trigger_start[id] = ppi->num_trigger;
+		for (size_t i = 0; i < n_rules; i++)
+		{
+			const char *selector = knowledge->contains_one_rules[i].selector;
+			if (strchr(selector, '*') != NULL) continue;
+			if (post_process_match(selector, ce->string[id])) ppi->num_trigger++;
+		}
+	}
+	ppi->trigger_start[ce->num_id] = ppi->num_trigger;
+
+	ppi->trigger = xalloc(ppi->num_trigger * sizeof(unsigned int));
+	memset(triggers, 0, n_rules * sizeof(bool));
+	for (size_t id = 1, n = 0; id < ce->num_id; id++)
+	{
+		for (size_t i = 0; i < n_rules; i++)
+		{
+			const char *selector = knowledge->contains_one_rules[i].selector;
+			if (strchr(selector, '*') != NULL) continue;
+			if (!post_process_match(selector, ce->string[id])) continue;
+			ppi->trigger[n++] = i;
+			triggers[i] = true;
+		}
+	}
+
+	/* Compile only the criterion links of rules that can be triggered. */
+	ppi->rule = xalloc(n_rules * sizeof(pp_compiled_rule));
+	for (size_t i = 0; i < n_rules; i++)
+	{
+		pp_compiled_rule *cr = &ppi->rule[i];
+
+		cr->criterion = NULL;
+		cr->num_criterion = 0;
+		if (triggers[i])
+			compile_rule(cr, ce, knowledge->contains_one_rules[i].link_set);
+	}
+
+	xfree(triggers, n_rules * sizeof(bool));
+	return ppi;
+}
+
+void pp_prune_index_delete(Pp_prune_index *ppi)
+{
+	if (NULL == ppi) return;
+
+	for (size_t i = 0; i < ppi->knowledge->n_contains_one_rules; i++)
+	{
+		pp_compiled_rule *cr = &ppi->rule[i];
+
+		for (size_t c = 0; c < cr->num_criterion; c++)
+		{
+			pp_criterion *crit = &cr->criterion[c];
+
+			for (size_t p = 0; p < crit->num_pattern; p++)
+				xfree(crit->pattern[p].id, crit->pattern[p].num_id * sizeof(uint16_t));
+			xfree(crit->pattern, crit->num_pattern * sizeof(pp_pattern));
+		}
+		xfree(cr->criterion, cr->num_criterion * sizeof(pp_criterion));
+	}
+	xfree(ppi->rule, ppi->knowledge->n_contains_one_rules * sizeof(pp_compiled_rule));
+	xfree(ppi->trigger, ppi->num_trigger * sizeof(unsigned int));
+	xfree(ppi->trigger_start, (ppi->num_id + 1) * sizeof(unsigned int));
+	xfree(ppi, sizeof(Pp_prune_index));
+}
+
+static inline bool id_present(const uint8_t *present, unsigned int id)
+{
+	return 0 != (present[id >> 3] & (1 << (id & 7)));
+}
+
+static bool compiled_rule_satisfiable(const pp_compiled_rule *cr,
+                                      const uint8_t *present)
+{
+	for (size_t c = 0; c < cr->num_criterion; c++)
+	{
+		const pp_criterion *crit = &cr->criterion[c];
+		size_t p;
+
+		for (p = 0; p < crit->num_pattern; p++)
+		{
+			const pp_pattern *pat = &crit->pattern[p];
+			size_t i;
+
+			for (i = 0; i < pat->num_id; i++)
+				if (id_present(present, pat->id[i])) break;
+			if (i == pat->num_id) break;
 		}
+		if (p == crit->num_pattern) return true;
 	}
 	return false;
 }
 
+/**
+ * pp_prune() using the compiled rules. Return the number of deleted
+ * disjuncts, or -1 if the sentence has connectors that are not
+ * enumerated (and then nothing is done).
+ */
+static int pp_prune_indexed(Sentence sent, Pp_prune_index *ppi)
+{
+	pp_knowledge *knowledge = ppi->knowledge;
+	size_t present_size = (ppi->num_id + 7) / 8;
+	uint8_t *present = xalloc(present_size);
+	int total_deleted = 0;
+	size_t w;
+
+	memset(present, 0, present_size);
+	for (w = 0; w < sent->length; w++)
+	{
+		for (Disjunct *d = sent->word[w].d; d != NULL; d = d->next)
+		{
+			for (int dir = 0; dir < 2; dir++)
+			{
+				for (Connector *c = ((dir) ? (d->left) : (d->right)); c != NULL; c = c->next)
+				{
+					if (0 == c->id)
+					{
+						xfree(present, present_size);
+						return -1;
+					}
+					present[c->id >> 3] |= 1 << (c->id & 7);
+				}
+			}
+		}
+	}
+
+	/* Which of the rules that the sentence triggers are unsatisfiable. */
+	size_t n_rules = knowledge->n_contains_one_rules;
+	bool *unsatisfiable = xalloc(n_rules * sizeof(bool));
+	for (size_t i = 0; i < n_rules; i++)
+	{
+		unsatisfiable[i] = (0 != ppi->rule[i].num_criterion) &&
+		                   !compiled_rule_satisfiable(&ppi->rule[i], present);
+	}
+
+	for (w = 0; w < sent->length; w++)
+	{
+		for (Disjunct *d = sent->word[w].d; d != NULL; d = d->next)
+		{
+			pp_rule *rule = NULL;
+
+			d->marked = true;
+			for (int dir = 0; (dir < 2) && (NULL == rule); dir++)
+			{
+				for (Connector *c = ((dir) ? (d->left) : (d->right));
+				     (c != NULL) && (NULL == rule); c = c->next)
+				{
+					for (unsigned int t = ppi->trigger_start[c->id];
+					     t < ppi->trigger_start[c->id + 1]; t++)
+					{
+						if (unsatisfiable[ppi->trigger[t]])
+						{
+							rule = &knowledge->contains_one_rules[ppi->trigger[t]];
+							break;
+						}
+					}
+				}
+			}
+
+			if (NULL != rule)
+			{
+				rule->use_count++;
+				d->marked = false; /* mark for deletion later */
+				total_deleted++;
+			}
+		}
+	}
+
+	xfree(unsatisfiable, n_rules * sizeof(bool));
+	xfree(present, present_size);
+
+	if (verbosity_level(D_PRUNE))
+		printf("pp_prune pass deleted %d\n", total_deleted);
+
+	return total_deleted;
+}
+
 static int pp_prune(Sentence sent, Parse_Options opts)
 {
 	pp_knowledge * knowledge;
@@ -1606,6 +2714,13 @@ static int pp_prune(Sentence sent, Parse_Options opts)
 
 	knowledge = sent->postprocessor->knowledge;
 
+	Pp_prune_index *ppi = sent->dict->pp_prune_index;
+	if ((NULL != ppi) && (ppi->knowledge == knowledge))
+	{
+		total_deleted = pp_prune_indexed(sent, ppi);
+		if (0 <= total_deleted) goto done;
+	}
+
 	cmt = cms_table_new();
 
 	for (w = 0; w < sent->length; w++)
@@ -1695,9 +2810,11 @@ static int pp_prune(Sentence sent, Parse_Options opts)
 		if (verbosity_level(D_PRUNE))
 			printf("pp_prune pass deleted %d\n", N_deleted);
 	}
-	delete_unmarked_disjuncts(sent);
 	cms_table_delete(cmt);
 
+done:
+	delete_unmarked_disjuncts(sent);
+
 	if (verbosity_level(D_PRUNE))
 	{
 		printf("\nAfter pp_pruning:\n");
@@ -1718,6 +2835,7 @@ static int pp_prune(Sentence sent, Parse_Options opts)
 void pp_and_power_prune(Sentence sent, Parse_Options opts)
 {
 	power_prune(sent, opts);
+	if (resources_exhausted_or_cancelled(opts->resources, sent)) return;
 	pp_prune(sent, opts);
 
 	return;
@@ -19,4 +19,7 @@
 int        power_prune(Sentence, Parse_Options);
 void       pp_and_power_prune(Sentence, Parse_Options);
 void       expression_prune(Sentence);
+void       dictionary_prune(Dictionary);
+Pp_prune_index *pp_prune_index_create(Dictionary);
+void       pp_prune_index_delete(Pp_prune_index *);
 #endif /* _PRUNE_H */
@@ -16,42 +16,32 @@
 
 #if !defined(_WIN32)
 	#include <sys/time.h>
-	#include <sys/resource.h>
 #endif
 
-#if defined(__linux__)
-	/* based on reading the man page for getrusage on linux, I inferred that
-	   I needed to include this.  However it doesn't seem to be necessary */
-	#include <unistd.h>
-#endif
-
-#if defined(__hpux__)
-	#include <sys/syscall.h>
-	int syscall(int, int, struct rusage *rusage);  /* can't find
-	                                                  the prototype for this */
-	#define getrusage(a, b)  syscall(SYS_GETRUSAGE, (a), (b))
-#endif /* __hpux__ */
-
-#if defined(__sun__)
-int getrusage(int who, struct rusage *rusage);
-/* Declaration missing from sys/resource.h in sun operating systems (?) */
-#endif /* __sun__ */
-
 #include "api-structures.h"
 #include "resources.h"
 #include "utilities.h"
 
 #define MAX_PARSE_TIME_UNLIMITED -1
-#define MAX_MEMORY_UNLIMITED ((size_t) -1)
 
-/** returns the current usage time clock in seconds */
+/**
+ * Return the current time in seconds. It is the elapsed (wall-clock)
+ * time, and not the CPU time of the process: the latter advances N
+ * times faster when N threads are parsing, which would make the
+ * parse time limit expire too soon.
+ */
 static double current_usage_time(void)
 {
-#if !defined(_WIN32)
-	struct rusage u;
-	getrusage (RUSAGE_SELF, &u);
-	return (u.ru_utime.tv_sec + ((double) u.ru_utime.tv_usec) / 1000000.0);
+#if defined(CLOCK_MONOTONIC)
+	struct timespec t;
+	clock_gettime(CLOCK_MONOTONIC, &t);
+	return (t.tv_sec + ((double) t.tv_nsec) / 1000000000.0);
+#elif !defined(_WIN32)
+	struct timeval t;
+	gettimeofday(&t, NULL);
+	return (t.tv_sec + ((double) t.tv_usec) / 1000000.0);
 #else
+	/* On Windows, clock() is the elapsed time since the process started. */
 	return ((double) clock())/CLOCKS_PER_SEC;
 #endif
 }
@@ -101,36 +91,74 @@ void resources_reset_space(Resources r)
 	r->space_when_parse_started = get_space_in_use();
 }
 
+/* The post-processing threads may check the resources concurrently,
+ * and a sentence may be cancelled from another thread. The flags only
+ * ever change from false to true during a parse. */
+#ifdef USE_PTHREADS
+#define get_flag(f) __atomic_load_n(&(f), __ATOMIC_RELAXED)
+#define set_flag(f) __atomic_store_n(&(f), true, __ATOMIC_RELAXED)
+#else
+#define get_flag(f) (f)
+#define set_flag(f) ((f) = true)
+#endif /* USE_PTHREADS */
+
 bool resources_exhausted(Resources r)
 {
-	if (r->timer_expired || r->memory_exhausted)
+	if (get_flag(r->timer_expired) || get_flag(r->memory_exhausted))
 		return true;
 
 	if (resources_timer_expired(r))
-		r->timer_expired = true;
+	{
+		set_flag(r->timer_expired);
+		return true;
+	}
 
 	if (resources_memory_exhausted(r))
-		r->memory_exhausted = true;
+	{
+		set_flag(r->memory_exhausted);
+		return true;
+	}
 
-	return (r->timer_expired || r->memory_exhausted);
+	return false;
+}
+
+/**
+ * Return true if the parse of the sentence should be abandoned:
+ * it has been cancelled by sentence_parse_cancel(), or the resources
+ * are exhausted. The inner parse loops call it only once per
+ * RESOURCES_CHECK_INTERVAL iterations, to avoid excess system calls.
+ */
+bool resources_exhausted_or_cancelled(Resources r, Sentence sent)
+{
+	if ((NULL != sent) && get_flag(sent->cancelled)) return true;
+	return (NULL != r) && resources_exhausted(r);
 }
 
 bool resources_timer_expired(Resources r)
 {
 	if (r->max_parse_time == MAX_PARSE_TIME_UNLIMITED) return false;
-	else return (r->timer_expired ||
+	else return (get_flag(r->timer_expired) ||
 	     (current_usage_time() - r->time_when_parse_started > r->max_parse_time));
 }
 
 bool resources_memory_exhausted(Resources r)
 {
 	if (r->max_memory == MAX_MEMORY_UNLIMITED) return false;
-	else return (r->memory_exhausted || (get_space_in_use() > r->max_memory));
+	else return (get_flag(r->memory_exhausted) || (get_space_in_use() > r->max_memory));
+}
+
+/**
+ * Record that the memory is exhausted, when a data structure could not
+ * stay within the memory limit (see the parse-count table in count.c).
+ */
+void resources_set_memory_exhausted(Resources r)
+{
+	set_flag(r->memory_exhausted);
 }
 
 #define RES_COL_WIDTH sizeof("                                     ")
 
-/** print out the cpu ticks since this was last called */
+/** print out the time since this was last called */
 static void resources_print_time(int verbosity, Resources r, const char * s)
 {
 	double now;
@@ -142,7 +170,7 @@ static void resources_print_time(int verbosity, Resources r, const char * s)
 	r->when_last_called = now;
 }
 
-/** print out the cpu ticks since this was last called */
+/** print out the time since this was last called */
 static void resources_print_total_time(int verbosity, Resources r)
 {
 	double now;
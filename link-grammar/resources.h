@@ -16,13 +16,21 @@
 #include "api-types.h"
 #include "link-includes.h"
 
+#define MAX_MEMORY_UNLIMITED ((size_t) -1)
+
+/* The inner parse loops call resources_exhausted_or_cancelled() once
+ * per this many iterations. Must be a power of 2. */
+#define RESOURCES_CHECK_INTERVAL (1U << 14)
+
 void      print_time(Parse_Options opts, const char * s);
 void      print_total_space(Parse_Options opts);
 void      resources_reset(Resources r);
 void      resources_reset_space(Resources r);
 bool      resources_timer_expired(Resources r);
 bool      resources_memory_exhausted(Resources r);
+void      resources_set_memory_exhausted(Resources r);
 bool      resources_exhausted(Resources r);
+bool      resources_exhausted_or_cancelled(Resources r, Sentence sent);
 Resources resources_create(void); 
 void      resources_delete(Resources ti);
 #endif /* _RESOURCES_H */
@@ -35,9 +35,14 @@ extern "C" {
 #include "dict-api.h"             // for print_expression()
 #include "linkage.h"
 #include "post-process.h"
+#include "resources.h"           // for resources_exhausted_or_cancelled()
 #include "score.h"               // for linkage_score()
 }
 
+// The solver is run for this many conflicts at a time, so that the
+// parse can be cancelled or time out while solving.
+#define SAT_CONFLICT_BUDGET 1000
+
 // Macro DEBUG_print is used to dump to stdout information while debugging
 #ifdef SAT_DEBUG
 #define DEBUG_print(x) (cout << x << endl)
@@ -1453,7 +1458,15 @@ Linkage SATEncoder::get_next_linkage()
    * Disconnected linkages are normally ignored, unless
    * !test=linkage-disconnected is used (and they are sane) */
   do {
-    if (!_solver->solve()) return NULL;
+    vec<Lit> no_assumptions;
+    lbool solved;
+    for (;;) {
+      _solver->setConfBudget(SAT_CONFLICT_BUDGET);
+      solved = _solver->solveLimited(no_assumptions);
+      if (solved != l_Undef) break;
+      if (resources_exhausted_or_cancelled(_opts->resources, _sent)) return NULL;
+    }
+    if (solved != l_True) return NULL;
 
     std::vector<int> components;
     connected = connectivity_components(components);
@@ -1790,8 +1803,8 @@ bool SATEncoderConjunctionFreeSentences::sat_extract_links(Linkage lkg)
 
     // Allocate memory for the connectors, because they should persist
     // beyond the lifetime of the sat-solver data structures.
-    clink.lc = connector_new();
-    clink.rc = connector_new();
+    clink.lc = connector_new(NULL);
+    clink.rc = connector_new(NULL);
 
     *clink.lc = lpc->connector;
     *clink.rc = rpc->connector;
@@ -1844,7 +1857,7 @@ bool SATEncoderConjunctionFreeSentences::sat_extract_links(Linkage lkg)
       lgdebug(+0, "Warning: No expression for word %zu\n", wi);
     }
 
-    d = build_disjuncts_for_exp(de, xnode_word[wi]->string, UNLIMITED_LEN);
+    d = build_disjuncts_for_exp(NULL, de, xnode_word[wi]->string, UNLIMITED_LEN);
     word_record_in_disjunct(xnode_word[wi]->word, d);
     lkg->chosen_disjuncts[wi] = d;
     free_Exp(de);
@@ -128,9 +128,9 @@ struct Connector_struct
 	                this could ever connect to.  Computed by
 	                setup_connectors() */
 	bool multi;  /* TRUE if this is a multi-connector */
-	uint8_t lc_start;     /* lc start position (or 0) - for match speedup. */
 	uint8_t uc_length;    /* uc part length - for match speedup. */
-	uint8_t uc_start;     /* uc start position - for match speedup. */
+	uint16_t id;          /* Dictionary connector ID (or 0), see
+	                         connector-enum.c - for match speedup. */
 	Connector * next;
 	const char * string; /* The connector name w/o the direction mark, e.g. AB */
 
@@ -146,6 +146,7 @@ static inline void connector_set_string(Connector *c, const char *s)
 {
 	c->string = s;
 	c->hash = -1;
+	c->id = 0;
 }
 static inline const char * connector_get_string(Connector *c)
 {
@@ -182,6 +183,7 @@ struct X_node_struct
 {
 	const char * string;       /* the word itself */
 	Exp * exp;
+	Exp * dict_exp;            /* the dictionary expression it copies */
 	X_node *next;
 	const Gword *word;         /* originating Wordgraph word */
 };
@@ -362,6 +364,8 @@ struct Parse_choice_struct
 	Parse_set * set[2];
 	Link        link[2];   /* the lc fields of these is NULL if there is no link used */
 	Disjunct *ld, *md, *rd;  /* the chosen disjuncts for the relevant three words */
+	                         /* For an island, md is the disjunct of the first
+	                            word of set[1] (used only for its cost). */
 };
 
 struct Parse_set_struct
@@ -376,6 +380,7 @@ struct Parse_set_struct
 	// double cost_cutoff;
 	Parse_choice * first;
 	Parse_choice * tail;
+	Kbest_node *   kbest;  /* Lowest-cost parses found so far, or NULL */
 };
 
 struct X_table_connector_struct
@@ -443,6 +448,18 @@ typedef struct StartingLinkAndDomain_s
 	int   domain;       /* domain which the link belongs to (-1: terminator)*/
 } StartingLinkAndDomain;
 
+/* The link sets of the knowledge file that a link name matches */
+#define PP_IGNORE                   0x01
+#define PP_DOMAIN_STARTER           0x02
+#define PP_URFL_DOMAIN_STARTER      0x04
+#define PP_URFL_ONLY_DOMAIN_STARTER 0x08
+#define PP_LEFT_DOMAIN_STARTER      0x10
+#define PP_DOMAIN_CONTAINS          0x20
+#define PP_RESTRICTED               0x40
+
+#define PP_BITS_WORD(i) ((i) / (8 * sizeof(pp_bits)))
+#define PP_BIT(i) (((pp_bits)1) << ((i) % (8 * sizeof(pp_bits))))
+
 typedef struct pp_rule_s
 {
 	/* Holds a single post-processing rule. Since rules come in many
@@ -454,8 +471,42 @@ typedef struct pp_rule_s
 	const char  **link_array; /* array holding the spelled-out names */
 	const char  *msg;     /* explanation (NULL=end sentinel in array)*/
 	int use_count;        /* Number of times rule has been applied   */
+
+	/* Contains rules: the bit of the rule in the rule_bits of a link
+	   class, for its selector and for its link array */
+	size_t selector_word;
+	size_t link_array_word;
+	pp_bits bit;
 } pp_rule;
 
+/**
+ * A symbol of the knowledge file (a link name, possibly with "#"
+ * wildcards), together with everything the rules say about it.
+ * The symbols are compiled when the knowledge file is loaded.
+ */
+typedef struct
+{
+	const char *str;
+	int next;              /* Next symbol in its hash bucket (-1: end) */
+	unsigned int flags;    /* PP_* link sets which contain it */
+	int starting_link;     /* First index in the starting link table */
+	pp_bits *rule_bits;    /* Contains rules which use it (see below) */
+} pp_symbol;
+
+/**
+ * What the rules say about a link name: the union of all the symbols
+ * which match it. The rule_bits are, in order, the contains_one rules
+ * it is the selector of, the contains_one rules it is in the link
+ * array of, and the same for the contains_none rules.
+ */
+struct pp_link_class_s
+{
+	const char *name;
+	unsigned int flags;
+	int domain;            /* Type of the domain it starts (-1: none) */
+	pp_bits *rule_bits;
+};
+
 typedef struct PPLexTable_s PPLexTable;
 struct pp_knowledge_s
 {
@@ -489,6 +540,13 @@ struct pp_knowledge_s
 	pp_linkset *set_of_links_starting_bounded_domain;
 	StartingLinkAndDomain *starting_link_lookup_table;
 	String_set *string_set;
+
+	/* The symbols of all the above, hashed by their upper-case part */
+	pp_symbol *symbol;
+	size_t n_symbols, symbol_size;
+	int *symbol_table;
+	size_t symbol_table_size;
+	size_t rule_words;     /* Number of pp_bits in rule_bits */
 };
 
 #endif
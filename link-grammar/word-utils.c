@@ -201,15 +201,23 @@ void free_connectors(Connector *e)
 	}
 }
 
-Connector * connector_new(void)
+/**
+ * Return a new connector. If the pool is NULL, it is allocated with
+ * xalloc(), and has to be freed with free_connectors(). Else it is
+ * released with the pool.
+ */
+Connector * connector_new(Pool_desc *connector_pool)
 {
-	Connector *c = (Connector *) xalloc(sizeof(Connector));
+	Connector *c;
+
+	if (NULL == connector_pool)
+		c = (Connector *) xalloc(sizeof(Connector));
+	else
+		c = (Connector *) pool_alloc(connector_pool);
 	init_connector(c);
 	c->nearest_word = 0;
 	c->multi = false;
-	c->lc_start = 0;
 	c->uc_length = 0;
-	c->uc_start = 0;
 	c->next = NULL;
 	c->string = "";
 	c->tableNext = NULL;
@@ -245,7 +253,7 @@ static void build_connector_set_from_expression(Connector_set * conset, Exp * e)
 	unsigned int h;
 	if (e->type == CONNECTOR_type)
 	{
-		c = connector_new();
+		c = connector_new(NULL);
 		c->string = e->u.string;
 		h = connector_set_hash(conset, c->string, e->dir);
 		c->next = conset->hash_table[h];
@@ -482,7 +490,6 @@ int calculate_connector_hash(Connector * c)
 	i = 0;
 	s = c->string;
 	if (islower((int) *s)) s++; /* ignore head-dependent indicator */
-	c->uc_start = s - c->string;
 	while (isupper((int) *s)) /* connector tables cannot contain UTF8, yet */
 	{
 		i += *s;
@@ -500,7 +507,6 @@ int calculate_connector_hash(Connector * c)
 	i = 0;
 	s = c->string;
 	if (islower((int) *s)) s++; /* ignore head-dependent indicator */
-	c->uc_start = s - c->string;
 	while (isupper((int) *s))
 	{
 		i = *s + (i << 6) + (i << 16) - i;
@@ -508,8 +514,7 @@ int calculate_connector_hash(Connector * c)
 	}
 #endif /* USE_SDBM */
 
-	c->lc_start = ('\0' == *s) ? 0 : s - c->string;
-	c->uc_length = s - c->string - c->uc_start;
+	c->uc_length = s - c->string - connector_uc_start(c);
 	c->hash = i;
 	return i;
 }
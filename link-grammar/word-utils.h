@@ -14,6 +14,7 @@
 #ifndef _LINK_GRAMMAR_WORD_UTILS_H_
 #define _LINK_GRAMMAR_WORD_UTILS_H_
 
+#include "memory-pool.h"
 #include "structures.h"
 
 /* Exp utilities ... */
@@ -32,16 +33,26 @@ void free_X_nodes(X_node *);
 
 
 /* Connector utilities ... */
-Connector * connector_new(void);
+Connector * connector_new(Pool_desc *);
 void free_connectors(Connector *);
 
 static inline Connector * init_connector(Connector *c)
 {
 	c->hash = -1;
+	c->id = 0;
 	c->length_limit = UNLIMITED_LEN;
 	return c;
 }
 
+/**
+ * Return the start position of the upper-case part of the connector
+ * string, i.e. 1 if it has a head-dependent indicator, else 0.
+ */
+static inline int connector_uc_start(const Connector *c)
+{
+	return islower((int) c->string[0]) ? 1 : 0;
+}
+
 /* Connector-set utilities ... */
 Connector_set * connector_set_create(Exp *e);
 void connector_set_delete(Connector_set * conset);
@@ -39,7 +39,7 @@
 
 Gword *gword_new(Sentence sent, const char *s)
 {
-	Gword *gword = malloc(sizeof(*gword));
+	Gword *gword = pool_alloc(sent->gword_pool);
 
 	memset(gword, 0, sizeof(*gword));
 	assert(NULL != gword, "Null-string subword");
@@ -28,8 +28,10 @@ static struct
 	int timeout;
 	int memory;
 	int linkage_limit;
+	int kbest;
 	int islands_ok;
 	int repeatable_rand;
+	int threads;
 	int spell_guess;
 	int short_length;
 	int batch_mode;
@@ -82,6 +84,7 @@ static Switch default_switches[] =
 	{"echo",       Bool, "Echoing of input sentence",       &local.echo_on},
 	{"graphics",   Bool, "Graphical display of linkage",    &local.display_on},
 	{"islands-ok", Bool, "Use of null-linked islands",      &local.islands_ok},
+	{"kbest",      Bool, "Process the lowest-cost linkages", &local.kbest},
 	{"limit",      Int,  "The maximum linkages processed",  &local.linkage_limit},
 	{"links",      Bool, "Display of complete link data",   &local.display_links},
 	{"memory",     Int,  "Max memory allowed",              &local.memory},
@@ -96,7 +99,8 @@ static Switch default_switches[] =
 #if defined HAVE_HUNSPELL || defined HAVE_ASPELL
 	{"spell",      Int, "Up to this many spell-guesses per unknown word", &local.spell_guess},
 #endif /* HAVE_HUNSPELL */
-	{"timeout",    Int,  "Abort parsing after this many seconds", &local.timeout},
+	{"threads",    Int,  "Threads for parsing long sentences", &local.threads},
+	{"timeout",    Int,  "Abort parsing after this many seconds (wall clock)", &local.timeout},
 #ifdef USE_SAT_SOLVER
 	{"use-sat",    Bool, "Use Boolean SAT-based parser",    &local.use_sat_solver},
 #endif /* USE_SAT_SOLVER */
@@ -419,8 +423,10 @@ static void put_opts_in_local_vars(Command_Options* copts)
 	local.timeout = parse_options_get_max_parse_time(opts);;
 	local.memory = parse_options_get_max_memory(opts);;
 	local.linkage_limit = parse_options_get_linkage_limit(opts);
+	local.kbest = parse_options_get_kbest(opts);
 	local.islands_ok = parse_options_get_islands_ok(opts);
 	local.repeatable_rand = parse_options_get_repeatable_rand(opts);
+	local.threads = parse_options_get_threads(opts);
 	local.spell_guess = parse_options_get_spell_guess(opts);
 	local.short_length = parse_options_get_short_length(opts);
 	local.cost_model = parse_options_get_cost_model_type(opts);
@@ -457,8 +463,10 @@ static void put_local_vars_in_opts(Command_Options* copts)
 	parse_options_set_max_parse_time(opts, local.timeout);
 	parse_options_set_max_memory(opts, local.memory);
 	parse_options_set_linkage_limit(opts, local.linkage_limit);
+	parse_options_set_kbest(opts, local.kbest);
 	parse_options_set_islands_ok(opts, local.islands_ok);
 	parse_options_set_repeatable_rand(opts, local.repeatable_rand);
+	parse_options_set_threads(opts, local.threads);
 	parse_options_set_spell_guess(opts, local.spell_guess);
 	parse_options_set_short_length(opts, local.short_length);
 	parse_options_set_cost_model_type(opts, local.cost_model);
@@ -0,0 +1,152 @@
+/***************************************************************************/
+/* Copyright (c) 2016 Linas Vepstas                                        */
+/* All rights reserved                                                     */
+/*                                                                         */
+/* Use of the link grammar parsing system is subject to the terms of the   */
+/* license set forth in the LICENSE file included with this software.      */
+/* This license allows free redistribution and use in source and binary    */
+/* forms, with or without modification, subject to certain conditions.     */
+/*                                                                         */
+/***************************************************************************/
+
+// Make sure that bounding the memory of the parse-count table doesn't
+// change the parse results: the counts and the linkages must be the
+// same as when the table is unbounded. The parse time is limited as
+// in link-parser, so a bounded table that makes the counting much
+// slower results in a timeout, and thus different results.
+//
+// Also make sure that the table never gets bigger than the limit: when
+// the counts in use don't fit, the parse must be abandoned as memory
+// exhausted, and the same way each time.
+
+#include <string>
+#include <vector>
+
+#include <locale.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "link-grammar/link-includes.h"
+
+// Collect the table sizes that are reported at verbosity 2.
+static void table_memory_handler(lg_errinfo *lge, void *data)
+{
+	static const char label[] = "++++ Count table memory";
+	std::vector<size_t> *table_memory = (std::vector<size_t> *)data;
+
+	if (0 == strncmp(lge->text, label, sizeof(label)-1))
+		table_memory->push_back(strtoul(lge->text + sizeof(label)-1, NULL, 10));
+}
+
+static std::vector<std::string> parse_one_sent(Dictionary dict,
+                                               Parse_Options opts,
+                                               const char *sent_str)
+{
+	std::vector<std::string> result;
+
+	Sentence sent = sentence_create(sent_str, dict);
+	sentence_split(sent, opts);
+	int num_linkages = sentence_parse(sent, opts);
+
+	result.push_back(std::to_string(sentence_num_linkages_found(sent)));
+	result.push_back(std::to_string(sentence_num_valid_linkages(sent)));
+	for (int li = 0; li < num_linkages; li++)
+	{
+		Linkage linkage = linkage_create(li, sent, opts);
+		char * str = linkage_print_diagram(linkage, true, 200);
+		result.push_back(str);
+		linkage_free_diagram(str);
+		linkage_delete(linkage);
+	}
+	sentence_delete(sent);
+
+	return result;
+}
+
+int main(int argc, char* argv[])
+{
+	const char *sents[] = {
+		"Frank felt vindicated when his long time friend Bill revealed that he was the winner of the competition.",
+		"William Petre is described as smooth and obliging in manner, yet reserved and resolved, and not given to many words.",
+		"The only thing that has prevented a collapse in the dollar so far is that it is the currency reserve of the world.",
+		"Mr. Johnson, who was working in his field that morning, said, \"The alien spaceship appeared right before my own two eyes.\"",
+		"He obtained the lease of the manor of Great Burstead Grange (near East Horndon) from the Abbey of Stratford Langthorne, and purchased the manor of Bayhouse in West Thurrock."
+	};
+	const int max_memory[] = { 16000000, 32000000 };
+	const int tight_max_memory[] = { 2000000, 4000000 };
+
+	setlocale(LC_ALL, "en_US.UTF-8");
+	Parse_Options opts = parse_options_create();
+	parse_options_set_max_parse_time(opts, 30);
+	dictionary_set_data_dir(DICTIONARY_DIR "/data");
+	Dictionary dict = dictionary_create_lang("en");
+	if (!dict) {
+		printf ("Fatal error: Unable to open the dictionary\n");
+		return 1;
+	}
+
+	int rc = 0;
+	for (const char *s : sents)
+	{
+		parse_options_set_max_memory(opts, -1);
+		std::vector<std::string> unbounded = parse_one_sent(dict, opts, s);
+
+		for (int mem : max_memory)
+		{
+			parse_options_set_max_memory(opts, mem);
+			std::vector<std::string> bounded = parse_one_sent(dict, opts, s);
+			if (bounded != unbounded)
+			{
+				printf("Mismatch with max_memory=%d (found %s instead of %s):\n%s\n",
+				       mem, bounded[0].c_str(), unbounded[0].c_str(), s);
+				rc = 1;
+			}
+		}
+	}
+	if (0 == rc) printf("Bounded and unbounded counts are the same\n");
+
+	std::vector<size_t> table_memory;
+	lg_error_handler old_handler =
+		lg_error_set_handler(table_memory_handler, &table_memory);
+	parse_options_set_verbosity(opts, 2);
+	for (int mem : tight_max_memory)
+	{
+		parse_options_set_max_memory(opts, mem);
+		for (const char *s : sents)
+		{
+			table_memory.clear();
+			std::vector<std::string> first = parse_one_sent(dict, opts, s);
+			bool exhausted = parse_options_memory_exhausted(opts);
+			std::vector<std::string> second = parse_one_sent(dict, opts, s);
+
+			if ((first != second) ||
+			    (exhausted != parse_options_memory_exhausted(opts)))
+			{
+				printf("Nondeterministic result with max_memory=%d:\n%s\n",
+				       mem, s);
+				rc = 1;
+			}
+			if (table_memory.empty())
+			{
+				printf("No count table memory reported:\n%s\n", s);
+				rc = 1;
+			}
+			for (size_t m : table_memory)
+			{
+				if (m > (size_t)mem/2)
+				{
+					printf("Count table memory %zu exceeds max_memory=%d:\n%s\n",
+					       m, mem, s);
+					rc = 1;
+				}
+			}
+		}
+	}
+	parse_options_set_verbosity(opts, 1);
+	lg_error_set_handler(old_handler, NULL);
+	if (0 == rc) printf("The count table stays within the memory limit\n");
+
+	dictionary_delete(dict);
+	parse_options_delete(opts);
+	return rc;
+}
@@ -0,0 +1,165 @@
+/***************************************************************************/
+/* Copyright (c) 2017 Linas Vepstas                                        */
+/* All rights reserved                                                     */
+/*                                                                         */
+/* Use of the link grammar parsing system is subject to the terms of the   */
+/* license set forth in the LICENSE file included with this software.      */
+/* This license allows free redistribution and use in source and binary    */
+/* forms, with or without modification, subject to certain conditions.     */
+/*                                                                         */
+/***************************************************************************/
+
+// Make sure that the kbest option gives the linkage_limit lowest-cost
+// linkages, sorted by cost, and that the linkages don't depend on the
+// number of threads.
+
+#include <algorithm>
+#include <math.h>
+#include <string>
+#include <vector>
+
+#include <locale.h>
+#include <stdio.h>
+#include "link-grammar/link-includes.h"
+
+// Enough to extract all the linkages of the sentences below.
+#define ALL_LINKAGES 100000
+
+static std::vector<double> parse_costs(Dictionary dict, Parse_Options opts,
+                                       const char *sent_str, bool *sorted)
+{
+	std::vector<double> result;
+
+	Sentence sent = sentence_create(sent_str, dict);
+	sentence_split(sent, opts);
+	sentence_parse(sent, opts);
+
+	int npp = sentence_num_linkages_post_processed(sent);
+	for (int i = 0; i < npp; i++)
+	{
+		result.push_back(sentence_disjunct_cost(sent, i));
+
+		// The linkages without violations come first, by cost.
+		if ((0 < i) && (0 == sentence_num_violations(sent, i)) &&
+		    (result[i] < result[i-1]))
+			*sorted = false;
+	}
+	if ((ALL_LINKAGES == parse_options_get_linkage_limit(opts)) &&
+	    (npp != sentence_num_linkages_found(sent)))
+		result.clear();
+	sentence_delete(sent);
+
+	return result;
+}
+
+static std::vector<std::string> parse_diagrams(Dictionary dict,
+                                               Parse_Options opts,
+                                               const char *sent_str)
+{
+	std::vector<std::string> result;
+
+	Sentence sent = sentence_create(sent_str, dict);
+	sentence_split(sent, opts);
+	int num_linkages = sentence_parse(sent, opts);
+
+	result.push_back(std::to_string(sentence_num_linkages_found(sent)));
+	result.push_back(std::to_string(sentence_num_valid_linkages(sent)));
+	for (int li = 0; li < num_linkages; li++)
+	{
+		Linkage linkage = linkage_create(li, sent, opts);
+		char * str = linkage_print_diagram(linkage, true, 200);
+		result.push_back(str);
+		linkage_free_diagram(str);
+		linkage_delete(linkage);
+	}
+	sentence_delete(sent);
+
+	return result;
+}
+
+int main(int argc, char* argv[])
+{
+	const char *sents[] = {
+		"The fact that he smiled at me gives me hope.",
+		"His shout had been involuntary, something anybody might have done.",
+		"Frank felt vindicated when his long time friend Bill revealed that he was the winner of the competition.",
+		"This this doesn't parse."
+	};
+	const int linkage_limit[] = { 5, 100 };
+	const int threads[] = { 2, 4 };
+
+	setlocale(LC_ALL, "en_US.UTF-8");
+	Parse_Options opts = parse_options_create();
+	parse_options_set_max_null_count(opts, 2);
+	dictionary_set_data_dir(DICTIONARY_DIR "/data");
+	Dictionary dict = dictionary_create_lang("en");
+	if (!dict) {
+		printf ("Fatal error: Unable to open the dictionary\n");
+		return 1;
+	}
+
+	int rc = 0;
+	for (const char *s : sents)
+	{
+		bool sorted = true;
+
+		parse_options_set_threads(opts, 1);
+		parse_options_set_kbest(opts, false);
+		parse_options_set_linkage_limit(opts, ALL_LINKAGES);
+		std::vector<double> all = parse_costs(dict, opts, s, &sorted);
+		if (all.empty())
+		{
+			printf("Not all the linkages are post-processed:\n%s\n", s);
+			rc = 1;
+			continue;
+		}
+		std::sort(all.begin(), all.end());
+
+		parse_options_set_kbest(opts, true);
+		for (int limit : linkage_limit)
+		{
+			parse_options_set_linkage_limit(opts, limit);
+			std::vector<double> best = parse_costs(dict, opts, s, &sorted);
+			if (!sorted)
+			{
+				printf("The linkages are not sorted by cost (limit %d):\n%s\n",
+				       limit, s);
+				rc = 1;
+			}
+
+			std::sort(best.begin(), best.end());
+			size_t num_best = std::min(all.size(), (size_t)limit);
+			bool lowest = (best.size() == num_best);
+			for (size_t i = 0; lowest && (i < num_best); i++)
+				if (fabs(best[i] - all[i]) > 1.0e-5) lowest = false;
+			if (!lowest)
+			{
+				printf("Not the %d lowest-cost linkages:\n%s\n", limit, s);
+				rc = 1;
+			}
+		}
+
+		for (bool kbest : { true, false })
+		{
+			parse_options_set_kbest(opts, kbest);
+			parse_options_set_linkage_limit(opts, 100);
+			parse_options_set_threads(opts, 1);
+			std::vector<std::string> one = parse_diagrams(dict, opts, s);
+			for (int nthreads : threads)
+			{
+				parse_options_set_threads(opts, nthreads);
+				if (parse_diagrams(dict, opts, s) != one)
+				{
+					printf("Different linkages with %d threads (kbest %d):\n%s\n",
+					       nthreads, kbest, s);
+					rc = 1;
+				}
+			}
+		}
+	}
+	if (0 == rc) printf("The k-best linkages are right\n");
+
+	dictionary_delete(dict);
+	parse_options_delete(opts);
+	return rc;
+}
@@ -0,0 +1,108 @@
+/***************************************************************************/
+/* Copyright (c) 2017 Linas Vepstas                                        */
+/* All rights reserved                                                     */
+/*                                                                         */
+/* Use of the link grammar parsing system is subject to the terms of the   */
+/* license set forth in the LICENSE file included with this software.      */
+/* This license allows free redistribution and use in source and binary    */
+/* forms, with or without modification, subject to certain conditions.     */
+/*                                                                         */
+/***************************************************************************/
+
+// Make sure that the lazy linkages of sentence_next_linkage() are the
+// same as the eager ones, in the same order, when the lowest-cost
+// linkages are asked for (the kbest option).
+
+#include <string>
+#include <vector>
+
+#include <locale.h>
+#include <stdio.h>
+#include "link-grammar/link-includes.h"
+
+static std::vector<std::string> parse_one_sent(Dictionary dict,
+                                               Parse_Options opts,
+                                               const char *sent_str,
+                                               bool *bounds_ok)
+{
+	std::vector<std::string> result;
+
+	Sentence sent = sentence_create(sent_str, dict);
+	sentence_split(sent, opts);
+	sentence_parse(sent, opts);
+
+	// Linkages that are not post-processed yet have no costs.
+	int npp = sentence_num_linkages_post_processed(sent);
+	if ((0 != sentence_num_violations(sent, npp)) ||
+	    (0.0 != sentence_disjunct_cost(sent, npp)) ||
+	    (0 != sentence_link_cost(sent, npp)))
+		*bounds_ok = false;
+
+	Linkage linkage;
+	while (NULL != (linkage = sentence_next_linkage(sent, opts)))
+	{
+		char * str = linkage_print_diagram(linkage, true, 200);
+		result.push_back(str);
+		linkage_free_diagram(str);
+		linkage_delete(linkage);
+	}
+	sentence_delete(sent);
+
+	return result;
+}
+
+int main(int argc, char* argv[])
+{
+	const char *sents[] = {
+		"This is a test.",
+		"The fact that he smiled at me gives me hope.",
+		"It was covered with bites.",
+		"His shout had been involuntary, something anybody might have done.",
+		"Frank felt vindicated when his long time friend Bill revealed that he was the winner of the competition.",
+		"This this doesn't parse."
+	};
+	const int linkage_limit[] = { 10, 100 };
+
+	setlocale(LC_ALL, "en_US.UTF-8");
+	Parse_Options opts = parse_options_create();
+	parse_options_set_max_null_count(opts, 2);
+	parse_options_set_kbest(opts, true);
+	dictionary_set_data_dir(DICTIONARY_DIR "/data");
+	Dictionary dict = dictionary_create_lang("en");
+	if (!dict) {
+		printf ("Fatal error: Unable to open the dictionary\n");
+		return 1;
+	}
+
+	int rc = 0;
+	for (int limit : linkage_limit)
+	{
+		parse_options_set_linkage_limit(opts, limit);
+		for (const char *s : sents)
+		{
+			bool bounds_ok = true;
+
+			parse_options_set_lazy_linkages(opts, false);
+			std::vector<std::string> eager = parse_one_sent(dict, opts, s, &bounds_ok);
+			parse_options_set_lazy_linkages(opts, true);
+			std::vector<std::string> lazy = parse_one_sent(dict, opts, s, &bounds_ok);
+
+			if (lazy != eager)
+			{
+				printf("Lazy linkages differ (%zu instead of %zu, limit %d):\n%s\n",
+				       lazy.size(), eager.size(), limit, s);
+				rc = 1;
+			}
+			if (!bounds_ok)
+			{
+				printf("Costs of a linkage that is not post-processed:\n%s\n", s);
+				rc = 1;
+			}
+		}
+	}
+	if (0 == rc) printf("Lazy and eager linkages are the same\n");
+
+	dictionary_delete(dict);
+	parse_options_delete(opts);
+	return rc;
+}
@@ -0,0 +1,68 @@
+/***************************************************************************/
+/* Copyright (c) 2017 Linas Vepstas                                        */
+/* All rights reserved                                                     */
+/*                                                                         */
+/* Use of the link grammar parsing system is subject to the terms of the   */
+/* license set forth in the LICENSE file included with this software.      */
+/* This license allows free redistribution and use in source and binary    */
+/* forms, with or without modification, subject to certain conditions.     */
+/*                                                                         */
+/***************************************************************************/
+
+// Cancel the parse of a sentence from a second thread, and make sure
+// that sentence_parse() then returns soon. The sentence takes tens of
+// seconds to parse with null links, and there is no timeout.
+
+#include <chrono>
+#include <thread>
+
+#include <locale.h>
+#include <stdio.h>
+#include "link-grammar/link-includes.h"
+
+int main(int argc, char* argv[])
+{
+	const char *sent_str =
+		"The problem is, or rather one of the problems, for there are many, "
+		"a sizeable proportion of which are continually clogging up the "
+		"civil, commercial, and criminal courts in all areas of the Galaxy, "
+		"and especially, where possible, the more corrupt ones, this.";
+
+	setlocale(LC_ALL, "en_US.UTF-8");
+	Parse_Options opts = parse_options_create();
+	parse_options_set_max_null_count(opts, 3);
+	dictionary_set_data_dir(DICTIONARY_DIR "/data");
+	Dictionary dict = dictionary_create_lang("en");
+	if (!dict) {
+		printf ("Fatal error: Unable to open the dictionary\n");
+		return 1;
+	}
+
+	Sentence sent = sentence_create(sent_str, dict);
+	sentence_split(sent, opts);
+
+	auto start = std::chrono::steady_clock::now();
+	std::thread canceller([sent]()
+	{
+		std::this_thread::sleep_for(std::chrono::milliseconds(500));
+		sentence_parse_cancel(sent);
+	});
+	sentence_parse(sent, opts);
+	auto elapsed = std::chrono::steady_clock::now() - start;
+	canceller.join();
+
+	int secs = std::chrono::duration_cast<std::chrono::seconds>(elapsed).count();
+	int rc = 0;
+	if (5 < secs)
+	{
+		printf("Cancelled parse returned only after %d seconds\n", secs);
+		rc = 1;
+	}
+	else
+		printf("Cancelled parse returned after %d seconds\n", secs);
+
+	sentence_delete(sent);
+	dictionary_delete(dict);
+	parse_options_delete(opts);
+	return rc;
+}
@@ -0,0 +1,126 @@
+/***************************************************************************/
+/* Copyright (c) 2017 Linas Vepstas                                        */
+/* All rights reserved                                                     */
+/*                                                                         */
+/* Use of the link grammar parsing system is subject to the terms of the   */
+/* license set forth in the LICENSE file included with this software.      */
+/* This license allows free redistribution and use in source and binary    */
+/* forms, with or without modification, subject to certain conditions.     */
+/*                                                                         */
+/***************************************************************************/
+
+// Walk the packed parse forest of a sentence, counting the parses of
+// each node from those of its sub-nodes, and make sure that the count
+// of the root is the number of linkages found.
+
+#include <vector>
+
+#include <locale.h>
+#include <stdio.h>
+#include "link-grammar/link-includes.h"
+
+static bool check_one_sent(Dictionary dict, Parse_Options opts,
+                           const char *sent_str)
+{
+	bool ok = true;
+
+	Sentence sent = sentence_create(sent_str, dict);
+	sentence_split(sent, opts);
+	sentence_parse(sent, opts);
+
+	Parse_forest pf = sentence_get_parse_forest(sent);
+	if (NULL == pf)
+	{
+		printf("No parse forest:\n%s\n", sent_str);
+		sentence_delete(sent);
+		return false;
+	}
+
+	size_t num_nodes = parse_forest_get_num_nodes(pf);
+	std::vector<double> count(num_nodes);
+	for (ForestIdx n = 0; n < num_nodes; n++)
+	{
+		ForestIdx first = parse_forest_get_node_first_choice(pf, n);
+		size_t num_choices = parse_forest_get_node_num_choices(pf, n);
+
+		count[n] = (0 == num_choices) ? 1.0 : 0.0;
+		for (ForestIdx c = first; c < first + num_choices; c++)
+		{
+			ForestIdx l = parse_forest_get_choice_left(pf, c);
+			ForestIdx r = parse_forest_get_choice_right(pf, c);
+			if ((l >= n) || (r >= n))
+			{
+				printf("Sub-node %zu or %zu doesn't precede node %zu:\n%s\n",
+				       l, r, n, sent_str);
+				ok = false;
+				break;
+			}
+			count[n] += count[l] * count[r];
+		}
+		if (!ok) break;
+		if (count[n] != parse_forest_get_node_count(pf, n))
+		{
+			printf("Node %zu has %g parses instead of %g:\n%s\n",
+			       n, count[n], parse_forest_get_node_count(pf, n), sent_str);
+			ok = false;
+			break;
+		}
+	}
+
+	if (ok && (count[num_nodes-1] != sentence_num_linkages_found(sent)))
+	{
+		printf("The forest has %g parses instead of %d:\n%s\n",
+		       count[num_nodes-1], sentence_num_linkages_found(sent), sent_str);
+		ok = false;
+	}
+	if (ok && (size_t)sentence_null_count(sent) != parse_forest_get_null_count(pf))
+	{
+		printf("The forest has a wrong null count:\n%s\n", sent_str);
+		ok = false;
+	}
+
+	if ((PARSE_FOREST_BAD_INDEX != parse_forest_get_node_first_choice(pf, num_nodes)) ||
+	    (PARSE_FOREST_BAD_INDEX != parse_forest_get_choice_left(pf, parse_forest_get_num_choices(pf))) ||
+	    (PARSE_FOREST_BAD_INDEX != parse_forest_get_choice_right(pf, parse_forest_get_num_choices(pf))))
+	{
+		printf("A bad forest index is not reported:\n%s\n", sent_str);
+		ok = false;
+	}
+
+	sentence_delete(sent);
+	return ok;
+}
+
+int main(int argc, char* argv[])
+{
+	const char *sents[] = {
+		"This is a test.",
+		"The fact that he smiled at me gives me hope.",
+		"It was covered with bites.",
+		"His shout had been involuntary, something anybody might have done.",
+		"Frank felt vindicated when his long time friend Bill revealed that he was the winner of the competition.",
+		"This this doesn't parse."
+	};
+
+	setlocale(LC_ALL, "en_US.UTF-8");
+	Parse_Options opts = parse_options_create();
+	parse_options_set_max_null_count(opts, 2);
+	parse_options_set_parse_forest(opts, true);
+	dictionary_set_data_dir(DICTIONARY_DIR "/data");
+	Dictionary dict = dictionary_create_lang("en");
+	if (!dict) {
+		printf ("Fatal error: Unable to open the dictionary\n");
+		return 1;
+	}
+
+	int rc = 0;
+	for (const char *s : sents)
+	{
+		if (!check_one_sent(dict, opts, s)) rc = 1;
+	}
+	if (0 == rc) printf("The parse forest counts are right\n");
+
+	dictionary_delete(dict);
+	parse_options_delete(opts);
+	return rc;
+}